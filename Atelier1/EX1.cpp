@@ -3,57 +3,78 @@
 #include <string>
 #include <sstream>
 #include <iomanip>
-#include "picosha2.h"
+#include <algorithm>
+#include <unordered_map>
+#include "merkle.h"
 
 using namespace std;
 
 // Fonction pour calculer le hash SHA256
-string sha256(const string& data) {
-    return picosha2::hash256_hex_string(data);
+Hash256 sha256(const string& data) {
+    return sha256Hash(data);
 }
 
 // Classe pour l'arbre de Merkle
 class MerkleTree {
 private:
-    vector<string> leaves;      // Feuilles de l'arbre (hashes des transactions)
-    vector<vector<string>> levels;  // Tous les niveaux de l'arbre
-    string root;                // Racine de l'arbre
+    // Tous les noeuds dans un seul tampon contigu, niveau par niveau :
+    // feuilles d'abord, racine en dernier. Le niveau l occupe
+    // nodes[levelOffsets[l], levelOffsets[l + 1]).
+    vector<Hash256> nodes;
+    vector<size_t> levelOffsets;
+    Hash256 root;                // Racine de l'arbre
     
-    // Combine deux hashes
-    string hashPair(const string& left, const string& right) {
-        return sha256(left + right);
+    // Table hash de feuille -> index, construite au premier besoin seulement
+    // (non thread-safe : un arbre partagé doit être interrogé une première
+    // fois avant d'être lu en parallèle)
+    mutable unordered_map<Hash256, size_t> leafIndex;
+    mutable bool leafIndexBuilt = false;
+    
+    const unordered_map<Hash256, size_t>& getLeafIndex() const {
+        if(!leafIndexBuilt) {
+            leafIndex.reserve(leafCount());
+            for(size_t i = 0; i < leafCount(); i++) {
+                leafIndex.emplace(nodes[i], i);    // doublons : premier index conservé
+            }
+            leafIndexBuilt = true;
+        }
+        return leafIndex;
+    }
+    
+    size_t leafCount() const { return levelOffsets.empty() ? 0 : levelOffsets[1]; }
+    size_t levelCount() const { return levelOffsets.empty() ? 0 : levelOffsets.size() - 1; }
+    size_t levelSize(size_t level) const { return levelOffsets[level + 1] - levelOffsets[level]; }
+    const Hash256& node(size_t level, size_t i) const { return nodes[levelOffsets[level] + i]; }
+    
+    // Réserve le tampon pour `count` feuilles et calcule les offsets des niveaux
+    void allocate(size_t count) {
+        levelOffsets.assign(1, 0);
+        if(count == 0) {
+            nodes.clear();
+            return;
+        }
+        size_t size = count;
+        levelOffsets.push_back(size);
+        while(size > 1) {
+            size = (size + 1) / 2;
+            levelOffsets.push_back(levelOffsets.back() + size);
+        }
+        nodes.resize(levelOffsets.back());
     }
     
-    // Construit l'arbre récursivement
+    // Remplit les niveaux en place, du bas vers le haut (paires hachées en
+    // parallèle ; nombre impair : le dernier est dupliqué)
     void buildTree() {
-        if(leaves.empty()) {
-            root = "";
+        if(leafCount() == 0) {
+            root = Hash256::zero();
             return;
         }
         
-        levels.clear();
-        levels.push_back(leaves);
-        
-        vector<string> currentLevel = leaves;
-        
-        while(currentLevel.size() > 1) {
-            vector<string> nextLevel;
-            
-            for(size_t i = 0; i < currentLevel.size(); i += 2) {
-                if(i + 1 < currentLevel.size()) {
-                    // Paire normale
-                    nextLevel.push_back(hashPair(currentLevel[i], currentLevel[i+1]));
-                } else {
-                    // Nombre impair : dupliquer le dernier élément
-                    nextLevel.push_back(hashPair(currentLevel[i], currentLevel[i]));
-                }
-            }
-            
-            levels.push_back(nextLevel);
-            currentLevel = nextLevel;
+        for(size_t level = 0; level + 1 < levelCount(); level++) {
+            merkleParentLevel(&nodes[levelOffsets[level]], levelSize(level), &nodes[levelOffsets[level + 1]]);
         }
         
-        root = currentLevel[0];
+        root = nodes.back();
     }
     
 public:
@@ -62,82 +83,118 @@ public:
         cout << "\n=== Construction de l'Arbre de Merkle ===" << endl;
         cout << "Nombre de transactions: " << transactions.size() << endl;
         
-        // Créer les feuilles (hash de chaque transaction)
+        // Créer les feuilles (hash de chaque transaction, hachées par lots SIMD)
+        // directement au début du tampon
+        allocate(transactions.size());
+        if(!transactions.empty()) {
+            sha256HashBatch(transactions, &nodes[0]);
+        }
         for(size_t i = 0; i < transactions.size(); i++) {
-            string hash = sha256(transactions[i]);
-            leaves.push_back(hash);
             cout << "Transaction " << i+1 << ": " << transactions[i] << endl;
-            cout << "  Hash: " << hash.substr(0, 16) << "..." << endl;
+            cout << "  Hash: " << nodes[i].toHex().substr(0, 16) << "..." << endl;
         }
         
         buildTree();
     }
     
-    string getRoot() const { 
+    Hash256 getRoot() const { 
         return root; 
     }
     
     // Afficher l'arbre complet
     void display() {
         cout << "\n=== Structure de l'Arbre ===" << endl;
-        for(int i = levels.size() - 1; i >= 0; i--) {
-            cout << "Niveau " << i << " (" << levels[i].size() << " noeuds):" << endl;
-            for(size_t j = 0; j < levels[i].size(); j++) {
-                cout << "  [" << j << "] " << levels[i][j].substr(0, 16) << "..." << endl;
+        for(int i = (int)levelCount() - 1; i >= 0; i--) {
+            cout << "Niveau " << i << " (" << levelSize(i) << " noeuds):" << endl;
+            for(size_t j = 0; j < levelSize(i); j++) {
+                cout << "  [" << j << "] " << node(i, j).toHex().substr(0, 16) << "..." << endl;
             }
         }
-        cout << "\nMerkle Root: " << root << endl;
+        cout << "\nMerkle Root: " << root.toHex() << endl;
+    }
+    
+    // Index de la transaction dans l'arbre, -1 si absente (O(1))
+    int findTransaction(const string& transaction) const {
+        const unordered_map<Hash256, size_t>& index = getLeafIndex();
+        auto it = index.find(sha256(transaction));
+        return (it == index.end()) ? -1 : (int)it->second;
     }
     
     // Vérifier si une transaction est dans l'arbre
-    bool verifyTransaction(const string& transaction) {
-        string txHash = sha256(transaction);
-        for(const auto& leaf : leaves) {
-            if(leaf == txHash) {
-                return true;
-            }
+    bool verifyTransaction(const string& transaction) const {
+        return findTransaction(transaction) >= 0;
+    }
+    
+    // Preuve d'après le contenu de la transaction ; false si elle est absente
+    bool generateProof(const string& transaction, MerkleProof& proof) const {
+        int txIndex = findTransaction(transaction);
+        if(txIndex < 0) {
+            return false;
         }
-        return false;
+        proof = generateProof(txIndex);
+        return true;
     }
     
     // Générer la preuve de Merkle pour une transaction
-    vector<string> generateProof(int txIndex) {
-        vector<string> proof;
+    MerkleProof generateProof(int txIndex) const {
+        MerkleProof proof;
+        proof.leafIndex = txIndex;
         
-        if(txIndex < 0 || txIndex >= leaves.size()) {
+        if(txIndex < 0 || (size_t)txIndex >= leafCount()) {
             return proof;
         }
         
-        int index = txIndex;
-        for(size_t level = 0; level < levels.size() - 1; level++) {
-            int pairIndex = (index % 2 == 0) ? index + 1 : index - 1;
-            
-            if(pairIndex < levels[level].size()) {
-                proof.push_back(levels[level][pairIndex]);
-            } else {
-                proof.push_back(levels[level][index]);
-            }
-            
-            index = index / 2;
+        // Frère de l'index i : i ^ 1, ou le noeud lui-même s'il est dupliqué
+        size_t index = txIndex;
+        for(size_t level = 0; level + 1 < levelCount(); level++) {
+            size_t sibling = index ^ 1;
+            proof.siblings.push_back(node(level, sibling < levelSize(level) ? sibling : index));
+            index /= 2;
         }
         
         return proof;
     }
-
-    // Vérifier une preuve de Merkle
-    static bool verifyProof(const string& transaction, const vector<string>& proof, const string& root) {
-        string currentHash = sha256(transaction);
+    
+    // Multipreuve pour plusieurs transactions : on remonte les index de
+    // niveau en niveau, seuls les frères absents de l'ensemble sont émis
+    MerkleMultiProof generateMultiProof(vector<size_t> txIndices) const {
+        MerkleMultiProof proof;
+        proof.leafCount = leafCount();
+        sort(txIndices.begin(), txIndices.end());
+        txIndices.erase(unique(txIndices.begin(), txIndices.end()), txIndices.end());
+        txIndices.erase(lower_bound(txIndices.begin(), txIndices.end(), leafCount()), txIndices.end());
+        proof.leafIndices = txIndices;
         
-        for(const auto& p : proof) {
-            // L'ordre (gauche/droite) est important. On essaie les deux.
-            // Dans une vraie implémentation, on stockerait la position (gauche/droite).
-            string hash1 = sha256(currentHash + p);
-            string hash2 = sha256(p + currentHash);
-            currentHash = sha256(p + currentHash); 
+        vector<size_t> current = txIndices;
+        for(size_t level = 0; level + 1 < levelCount(); level++) {
+            vector<size_t> next;
+            for(size_t i = 0; i < current.size(); i++) {
+                size_t sibling = current[i] ^ 1;
+                if(i + 1 < current.size() && current[i + 1] == sibling) {
+                    i++;    // frère déjà dans l'ensemble
+                } else if(sibling < levelSize(level)) {
+                    proof.nodes.push_back(node(level, sibling));
+                }
+                next.push_back(current[i] / 2);
+            }
+            current.swap(next);
         }
-        
-        // Le hash calculé doit correspondre à la racine de l'arbre
-        return currentHash == root;
+        return proof;
+    }
+    
+    // Feuille (hash de transaction) d'index i
+    const Hash256& getLeaf(size_t i) const {
+        return nodes[i];
+    }
+    
+    size_t getLeafCount() const {
+        return leafCount();
+    }
+
+    // Vérifier une preuve de Merkle : l'index de la feuille donne le côté
+    // du frère à chaque niveau, un seul hashPair par niveau
+    static bool verifyProof(const string& transaction, const MerkleProof& proof, const Hash256& root) {
+        return verifyMerkleProof(sha256(transaction), proof, root);
     }
 };
 
@@ -204,10 +261,17 @@ int main() {
     MerkleTree tree3(transactions3);
     
     cout << "\nGénération de la preuve pour Transaction C (index 2):" << endl;
-    vector<string> proof = tree3.generateProof(2);
+    MerkleProof proof = tree3.generateProof(2);
     cout << "Chemin de preuve:" << endl;
-    for(size_t i = 0; i < proof.size(); i++) {
-        cout << "  Niveau " << i << ": " << proof[i].substr(0, 16) << "..." << endl;
+    for(size_t i = 0; i < proof.siblings.size(); i++) {
+        cout << "  Niveau " << i << ": " << proof.siblings[i].toHex().substr(0, 16) << "..."
+             << (proof.siblingOnLeft(i) ? " (frère à gauche)" : " (frère à droite)") << endl;
+    }
+    
+    // Même preuve, retrouvée à partir du contenu de la transaction
+    MerkleProof byContent;
+    if(tree3.generateProof("Transaction C", byContent)) {
+        cout << "Preuve retrouvée par contenu: index " << byContent.leafIndex << endl;
     }
     
     // Vérification de la preuve
@@ -220,6 +284,32 @@ int main() {
     bool isProofValid2 = MerkleTree::verifyProof("Transaction X", proof, tree3.getRoot());
     cout << "La preuve est-elle valide? " << (isProofValid2 ? "OUI" : "NON") << endl;
     
+    // Vérification groupée de toutes les preuves de l'arbre
+    cout << "\nVérification groupée des " << tree3.getLeafCount() << " preuves:" << endl;
+    vector<Hash256> leaves;
+    vector<MerkleProof> proofs;
+    for(size_t i = 0; i < tree3.getLeafCount(); i++) {
+        leaves.push_back(tree3.getLeaf(i));
+        proofs.push_back(tree3.generateProof(i));
+    }
+    vector<char> results = verifyMerkleProofs(leaves, proofs, tree3.getRoot());
+    size_t validCount = count(results.begin(), results.end(), 1);
+    cout << "Preuves valides: " << validCount << "/" << results.size() << endl;
+    
+    // Multipreuve : les noeuds communs aux chemins ne sont transmis qu'une fois
+    vector<size_t> wanted = {1, 2, 3, 6};
+    MerkleMultiProof multi = tree3.generateMultiProof(wanted);
+    vector<Hash256> wantedLeaves;
+    size_t separateSize = 0;
+    for(size_t i : wanted) {
+        wantedLeaves.push_back(tree3.getLeaf(i));
+        separateSize += tree3.generateProof(i).siblings.size();
+    }
+    cout << "\nMultipreuve pour les transactions B, C, D et G:" << endl;
+    cout << "  Noeuds transmis: " << multi.nodes.size() << " (contre " << separateSize
+         << " avec des preuves séparées)" << endl;
+    cout << "  Valide? " << (verifyMerkleMultiProof(wantedLeaves, multi, tree3.getRoot()) ? "OUI" : "NON") << endl;
+    
     // ========== EXEMPLE 4 : Comparaison de deux arbres ==========
     cout << "\n\n" << string(60, '=') << endl;
     cout << "EXEMPLE 4 : Comparaison de Merkle Roots" << endl;
@@ -233,9 +323,9 @@ int main() {
     MerkleTree treeB(setB);
     MerkleTree treeC(setC);
     
-    cout << "\nSet A Root: " << treeA.getRoot().substr(0, 32) << "..." << endl;
-    cout << "Set B Root: " << treeB.getRoot().substr(0, 32) << "..." << endl;
-    cout << "Set C Root: " << treeC.getRoot().substr(0, 32) << "..." << endl;
+    cout << "\nSet A Root: " << treeA.getRoot().toHex().substr(0, 32) << "..." << endl;
+    cout << "Set B Root: " << treeB.getRoot().toHex().substr(0, 32) << "..." << endl;
+    cout << "Set C Root: " << treeC.getRoot().toHex().substr(0, 32) << "..." << endl;
     
     cout << "\nSet A == Set B? " << (treeA.getRoot() == treeB.getRoot() ? "OUI (identiques)" : "NON") << endl;
     cout << "Set A == Set C? " << (treeA.getRoot() == treeC.getRoot() ? "OUI" : "NON (différents)") << endl;
@@ -249,7 +339,7 @@ int main() {
 
 /* 
 COMPILATION:
-g++ -o EX1 EX1.cpp -std=c++11
+g++ -o EX1 EX1.cpp -std=c++11 -pthread
 
 EXECUTION:
 ./EX1
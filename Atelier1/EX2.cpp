@@ -4,74 +4,159 @@
 #include <sstream>
 #include <iomanip>
 #include <chrono>
-#include "picosha2.h"
+#include "hash256.h"
+#include "block_header.h"
+#include "../common/mining.h"
 
 using namespace std;
 using namespace chrono;
 
 // Fonction pour calculer le hash SHA256
-string sha256(const string& data) {
-    return picosha2::hash256_hex_string(data);
+Hash256 sha256(const string& data) {
+    return sha256Hash(data);
 }
 
+// ========== BLOC GENESIS CALCULÉ À LA COMPILATION ==========
+// Horodatage et nonces fixes : le genesis est identique à chaque exécution
+// et son hash est calculé par le compilateur, rien n'est miné au démarrage.
+// Nonces trouvés hors ligne pour 20 bits de tête à zéro (5 zéros hexadécimaux).
+constexpr char GENESIS_DATA[] = "Genesis Block";
+constexpr long long GENESIS_TIMESTAMP = 1735689600000LL;   // 01/01/2025 00:00 UTC
+constexpr uint32_t GENESIS_TARGET_BITS = 20;
+constexpr uint64_t GENESIS_NONCE_SHA256 = 338129;
+constexpr uint64_t GENESIS_NONCE_SHA256D = 1696878;
+
+// Même en-tête que Block::header() pour le bloc 0
+constexpr BlockHeader genesisHeader(uint64_t nonce) {
+    return BlockHeader{BlockHeader::k_version, 0, Hash256{}, toHash256(picosha2::constexpr_hash256(GENESIS_DATA)),
+                       GENESIS_TIMESTAMP, GENESIS_TARGET_BITS, 0, nonce};
+}
+
+constexpr Hash256 GENESIS_HASH_SHA256 = constexprHashHeader(genesisHeader(GENESIS_NONCE_SHA256), HashMode::SHA256);
+constexpr Hash256 GENESIS_HASH_SHA256D = constexprHashHeader(genesisHeader(GENESIS_NONCE_SHA256D), HashMode::SHA256D);
+
+constexpr Target GENESIS_TARGET = Target::fromLeadingZeroBits(GENESIS_TARGET_BITS);
+static_assert(GENESIS_TARGET.isMetBy(GENESIS_HASH_SHA256), "Nonce genesis SHA256 invalide");
+static_assert(GENESIS_TARGET.isMetBy(GENESIS_HASH_SHA256D), "Nonce genesis SHA256D invalide");
+
+// Affichage console du minage : une ligne tous les `interval` essais de
+// chaque thread (0 : aucune), puis le débit. Sans observateur, rien n'est
+// affiché pendant la recherche.
+class ConsoleMiningObserver : public mining::MiningObserver {
+public:
+    explicit ConsoleMiningObserver(unsigned long long interval = 100000) : MiningObserver(interval) {}
+    
+    void onProgress(const mining::MiningProgress& progress) override {
+        cout << "  Nonce: " << progress.nonce << " (thread " << progress.worker << ") - "
+             << progress.hashes << " essais - " << static_cast<unsigned long long>(progress.hashRate()) << " H/s" << endl;
+    }
+    
+    void onFinish(const mining::MiningResult& result) override {
+        cout << "  Débit: " << static_cast<unsigned long long>(result.hashRate()) << " H/s sur "
+             << result.threads() << " thread(s), " << result.totalHashes() << " essais en "
+             << fixed << setprecision(2) << result.seconds * 1000 << " ms" << endl;
+        for(size_t t = 0; t < result.workers.size() && result.workers.size() > 1; t++) {
+            cout << "    thread " << t << ": " << result.workers[t].hashes << " hashes, "
+                 << static_cast<unsigned long long>(result.workers[t].hashRate()) << " H/s" << endl;
+        }
+    }
+};
+
 // Classe Block pour Proof of Work
 class Block {
 private:
     int index;
-    string previousHash;
+    Hash256 previousHash;
     string data;
     long long timestamp;
-    int nonce;
-    string hash;
+    uint32_t target;       // bits de tête à zéro exigés (fixé au minage)
+    uint64_t extraNonce;   // incrémenté si tout l'espace des nonces est épuisé
+    uint64_t nonce;
+    Hash256 hash;
+    HashMode hashMode;     // SHA256 ou double SHA-256 (style Bitcoin)
+    
+    Block(HashMode mode, uint64_t genesisNonce, Hash256 genesisHash)
+        : index(0), previousHash(Hash256::zero()), data(GENESIS_DATA), timestamp(GENESIS_TIMESTAMP),
+          target(GENESIS_TARGET_BITS), extraNonce(0), nonce(genesisNonce), hash(genesisHash), hashMode(mode) {}
     
 public:
-    Block(int idx, string prevHash, string d) 
-        : index(idx), previousHash(prevHash), data(d), nonce(0) {
+    Block(int idx, Hash256 prevHash, string d, HashMode mode = HashMode::SHA256) 
+        : index(idx), previousHash(prevHash), data(d), target(0), extraNonce(0), nonce(0), hashMode(mode) {
         timestamp = duration_cast<milliseconds>(
             system_clock::now().time_since_epoch()
         ).count();
         hash = calculateHash();
     }
     
-    string calculateHash() const {
-        stringstream ss;
-        ss << index << previousHash << data << timestamp << nonce;
-        return sha256(ss.str());
+    // Bloc genesis : tous les champs sont des constantes de compilation
+    static Block genesis(HashMode mode) {
+        bool doubleHash = (mode == HashMode::SHA256D);
+        return Block(mode, doubleHash ? GENESIS_NONCE_SHA256D : GENESIS_NONCE_SHA256,
+                     doubleHash ? GENESIS_HASH_SHA256D : GENESIS_HASH_SHA256);
+    }
+    
+    // En-tête binaire du bloc ; les données y sont engagées par leur hash
+    BlockHeader header() const {
+        return BlockHeader{BlockHeader::k_version, static_cast<uint32_t>(index), previousHash, sha256(data),
+                           static_cast<uint64_t>(timestamp), target, extraNonce, nonce};
+    }
+    
+    // Octets hachés pour ce bloc
+    string headerData() const {
+        BlockHeader::Bytes bytes = header().encode();
+        return string(reinterpret_cast<const char*>(bytes.data), sizeof(bytes.data));
     }
     
-    // Proof of Work : Miner le bloc
-    void mineBlock(int difficulty) {
-        string target(difficulty, '0');
+    Hash256 calculateHash() const {
+        return header().hash(hashMode);
+    }
+    
+    // Proof of Work : Miner le bloc (un thread par coeur du pool, chacun sur
+    // sa tranche de l'espace des nonces)
+    // Difficulté en bits de tête à zéro
+    mining::MiningResult mineBlock(uint32_t difficultyBits, MiningEngine engine = MiningEngine::Simd,
+                                   mining::MiningObserver* observer = nullptr,
+                                   parallel::ThreadPool& pool = parallel::defaultPool()) {
+        Target goal = Target::fromLeadingZeroBits(difficultyBits);
         
-        cout << "\n🔨 Mining block " << index << " avec difficulté " << difficulty << "..." << endl;
-        cout << "Recherche d'un hash commençant par: " << target << endl;
+        cout << "\n🔨 Mining block " << index << " avec difficulté " << difficultyBits << " bits ("
+             << miningEngineToString(engine) << ")..." << endl;
+        cout << "Recherche d'un hash inférieur ou égal à: " << goal.toHex().substr(0, 16) << "..." << endl;
         
         auto start = high_resolution_clock::now();
         
-        while(hash.substr(0, difficulty) != target) {
-            nonce++;
-            hash = calculateHash();
-            
-            // Afficher progression tous les 100000 essais
-            if(nonce % 100000 == 0) {
-                cout << "  Nonce: " << nonce << " - Hash: " << hash.substr(0, 20) << "..." << endl;
-            }
-        }
+        target = difficultyBits;
+        BlockHeader base = header();
+        mining::MiningResult result = mining::mine([&](unsigned, uint64_t extra) {
+            // Midstate : le premier bloc de l'en-tête est compressé une seule
+            // fois par thread, seul le bloc final (nonce + padding) est recalculé
+            BlockHeader candidateHeader = base;
+            candidateHeader.extraNonce = extra;
+            HeaderNonceSearch search(candidateHeader, hashMode, goal, engine);
+            return [search = std::move(search)](uint64_t candidate) mutable {
+                return search.meetsTarget(candidate);
+            };
+        }, mining::MiningLimits(), pool, observer);
+        
+        extraNonce = result.extraNonce;
+        nonce = result.nonce;
+        hash = calculateHash();
         
         auto end = high_resolution_clock::now();
         auto duration = duration_cast<milliseconds>(end - start);
         
         cout << "✅ Block miné!" << endl;
-        cout << "  Nonce trouvé: " << nonce << endl;
-        cout << "  Hash: " << hash << endl;
+        cout << "  Nonce trouvé: " << nonce << " (thread " << result.winner << ")" << endl;
+        cout << "  Hash: " << hash.toHex() << endl;
         cout << "  Temps d'exécution: " << duration.count() << " ms" << endl;
+        return result;
     }
     
     // Getters
-    string getHash() const { return hash; }
+    Hash256 getHash() const { return hash; }
     int getIndex() const { return index; }
-    int getNonce() const { return nonce; }
-    string getPreviousHash() const { return previousHash; }
+    uint64_t getNonce() const { return nonce; }
+    Hash256 getPreviousHash() const { return previousHash; }
     string getData() const { return data; }
     
     void display() const {
@@ -79,8 +164,8 @@ public:
         cout << "│ Block #" << index << setw(44) << "│" << endl;
         cout << "├─────────────────────────────────────────────────────┤" << endl;
         cout << "│ Données: " << left << setw(42) << data.substr(0, 42) << "│" << endl;
-        cout << "│ Hash précédent: " << previousHash.substr(0, 32) << "..." << setw(2) << "│" << endl;
-        cout << "│ Hash: " << hash.substr(0, 32) << "..." << setw(15) << "│" << endl;
+        cout << "│ Hash précédent: " << previousHash.toHex().substr(0, 32) << "..." << setw(2) << "│" << endl;
+        cout << "│ Hash: " << hash.toHex().substr(0, 32) << "..." << setw(15) << "│" << endl;
         cout << "│ Nonce: " << right << setw(44) << nonce << "│" << endl;
         cout << "│ Timestamp: " << setw(40) << timestamp << "│" << endl;
         cout << "└─────────────────────────────────────────────────────┘" << endl;
@@ -91,34 +176,50 @@ public:
 class Blockchain {
 private:
     vector<Block> chain;
-    int difficulty;
+    uint32_t difficultyBits;   // bits de tête à zéro exigés
+    HashMode hashMode;
+    mining::MiningObserver* observer;   // progression du minage (optionnel)
     
 public:
-    Blockchain(int diff = 2) : difficulty(diff) {
+    Blockchain(uint32_t diffBits = 8, HashMode mode = HashMode::SHA256)
+        : difficultyBits(diffBits), hashMode(mode), observer(nullptr) {
         // Créer le bloc Genesis
-        cout << "\n🔗 Création de la Blockchain avec difficulté " << difficulty << endl;
-        Block genesis(0, "0", "Genesis Block");
-        genesis.mineBlock(difficulty);
-        chain.push_back(genesis);
+        cout << "\n🔗 Création de la Blockchain avec difficulté " << difficultyBits << " bits"
+             << " (" << hashModeToString(hashMode) << ")" << endl;
+        chain.push_back(Block::genesis(hashMode));
+        cout << "Bloc Genesis précalculé à la compilation (nonce " << chain[0].getNonce()
+             << ", hash " << chain[0].getHash().toHex().substr(0, 20) << "...)" << endl;
     }
     
     Block getLastBlock() const {
         return chain.back();
     }
     
+    void setObserver(mining::MiningObserver* miningObserver) {
+        observer = miningObserver;
+    }
+    
     void addBlock(string data) {
-        Block newBlock(chain.size(), getLastBlock().getHash(), data);
-        newBlock.mineBlock(difficulty);
+        Block newBlock(chain.size(), getLastBlock().getHash(), data, hashMode);
+        newBlock.mineBlock(difficultyBits, MiningEngine::Simd, observer);
         chain.push_back(newBlock);
     }
     
     bool isChainValid() const {
+        // Les hashes des blocs sont indépendants : on les recalcule tous par lots
+        vector<string> headers;
+        for(const auto& block : chain) {
+            headers.push_back(block.headerData());
+        }
+        vector<Hash256> hashes = hashHeaderBatch(headers, hashMode);
+        Target goal = Target::fromLeadingZeroBits(difficultyBits);
+        
         for(size_t i = 1; i < chain.size(); i++) {
             const Block& currentBlock = chain[i];
             const Block& previousBlock = chain[i-1];
             
             // Vérifier que le hash est correct
-            if(currentBlock.getHash() != currentBlock.calculateHash()) {
+            if(currentBlock.getHash() != hashes[i]) {
                 cout << "❌ Hash invalide pour le bloc " << i << endl;
                 return false;
             }
@@ -130,8 +231,7 @@ public:
             }
             
             // Vérifier la difficulté
-            string target(difficulty, '0');
-            if(currentBlock.getHash().substr(0, difficulty) != target) {
+            if(!goal.isMetBy(currentBlock.getHash())) {
                 cout << "❌ Difficulté non respectée pour le bloc " << i << endl;
                 return false;
             }
@@ -158,16 +258,18 @@ void testDifficulties() {
     cout << "TEST : Comparaison des temps de minage selon la difficulté" << endl;
     cout << string(70, '=') << endl;
     
-    vector<int> difficulties = {1, 2, 3, 4, 5};
+    // En bits de tête à zéro : 18 n'a pas d'équivalent en zéros hexadécimaux
+    vector<uint32_t> difficulties = {4, 8, 12, 16, 18, 20};
     vector<long long> times;
+    ConsoleMiningObserver summary(0);   // bilan seul, sans progression
     
-    for(int diff : difficulties) {
-        cout << "\n\n>>> DIFFICULTÉ : " << diff << " <<<" << endl;
+    for(uint32_t diff : difficulties) {
+        cout << "\n\n>>> DIFFICULTÉ : " << diff << " bits <<<" << endl;
         
         auto start = high_resolution_clock::now();
         
-        Block testBlock(1, "0000000000000000", "Test block");
-        testBlock.mineBlock(diff);
+        Block testBlock(1, Hash256::zero(), "Test block");
+        testBlock.mineBlock(diff, MiningEngine::Simd, &summary);
         
         auto end = high_resolution_clock::now();
         auto duration = duration_cast<milliseconds>(end - start);
@@ -178,7 +280,7 @@ void testDifficulties() {
     cout << "\n\n╔═══════════════════════════════════════════════════════╗" << endl;
     cout << "║         TABLEAU RÉCAPITULATIF DES TEMPS              ║" << endl;
     cout << "╠═══════════════════════════════════════════════════════╣" << endl;
-    cout << "║ Difficulté │ Temps (ms) │ Facteur multiplicatif    ║" << endl;
+    cout << "║ Bits       │ Temps (ms) │ Facteur multiplicatif    ║" << endl;
     cout << "╠════════════╪════════════╪══════════════════════════╣" << endl;
     
     for(size_t i = 0; i < difficulties.size(); i++) {
@@ -194,9 +296,39 @@ void testDifficulties() {
     cout << "╚════════════╧════════════╧══════════════════════════╝" << endl;
     
     cout << "\n📊 Analyse:" << endl;
-    cout << "- Chaque augmentation de difficulté multiplie le temps par ~16" << endl;
-    cout << "- Ceci est dû au fait que chaque zéro supplémentaire réduit" << endl;
-    cout << "  les possibilités de 1/16 (car hash en hexadécimal)" << endl;
+    cout << "- Chaque bit de difficulté supplémentaire double le temps moyen" << endl;
+    cout << "- 4 bits (un zéro hexadécimal) le multiplient par ~16 ; la cible" << endl;
+    cout << "  binaire permet de régler le temps de bloc entre les deux" << endl;
+}
+
+// Même bloc miné avec chaque moteur : le nonce trouvé est le même, seul le
+// débit change
+void testMiningEngines() {
+    cout << "\n\n" << string(70, '=') << endl;
+    cout << "TEST : Moteur scalaire vs balayage SIMD des nonces" << endl;
+    cout << string(70, '=') << endl;
+    
+    const uint32_t bits = 22;
+    vector<double> rates;
+    for(HashMode mode : {HashMode::SHA256, HashMode::SHA256D}) {
+        Block block(1, Hash256::zero(), "Test moteurs", mode);
+        for(MiningEngine engine : {MiningEngine::Scalar, MiningEngine::Simd}) {
+            Block copy = block;
+            rates.push_back(copy.mineBlock(bits, engine).hashRate());
+        }
+    }
+    
+    cout << "\n📊 Débit (" << bits << " bits, " << parallel::defaultPool().size() << " thread(s)):" << endl;
+    const char* modes[] = {"SHA256", "SHA256D"};
+    for(size_t m = 0; m < 2; m++) {
+        double scalar = rates[2 * m];
+        double simd = rates[2 * m + 1];
+        cout << "  " << left << setw(8) << modes[m] << right
+             << " scalaire: " << setw(10) << static_cast<unsigned long long>(scalar) << " H/s"
+             << "  " << miningEngineToString(MiningEngine::Simd) << ": " << setw(10)
+             << static_cast<unsigned long long>(simd) << " H/s"
+             << "  (x" << fixed << setprecision(2) << (scalar > 0 ? simd / scalar : 0) << ")" << endl;
+    }
 }
 
 int main() {
@@ -209,7 +341,9 @@ int main() {
     cout << "EXEMPLE 1 : Création d'une blockchain avec PoW" << endl;
     cout << string(60, '=') << endl;
     
-    Blockchain blockchain(3);
+    Blockchain blockchain(12);
+    ConsoleMiningObserver progress;
+    blockchain.setObserver(&progress);
     
     blockchain.addBlock("Transaction: Alice -> Bob 100€");
     blockchain.addBlock("Transaction: Bob -> Charlie 50€");
@@ -223,9 +357,32 @@ int main() {
     cout << string(60, '=') << endl;
     cout << (blockchain.isChainValid() ? "✅ La blockchain est VALIDE" : "❌ La blockchain est INVALIDE") << endl;
     
+    // En-tête binaire du dernier bloc, relu champ par champ
+    string headerBytes = blockchain.getLastBlock().headerData();
+    BlockHeader decoded;
+    if(BlockHeader::decode(reinterpret_cast<const picosha2::byte_t*>(headerBytes.data()), headerBytes.size(), decoded)) {
+        cout << "En-tête binaire (" << headerBytes.size() << " octets): hauteur " << decoded.height
+             << ", cible " << decoded.target << " bits, nonce " << decoded.nonce
+             << " (offset " << BlockHeader::k_nonce_offset << ")" << endl;
+    }
+    
     // ========== EXEMPLE 2 : Test des différentes difficultés ==========
     testDifficulties();
     
+    // ========== EXEMPLE 3 : Double SHA-256 ==========
+    cout << "\n\n" << string(60, '=') << endl;
+    cout << "EXEMPLE 3 : Blockchain avec double SHA-256 (style Bitcoin)" << endl;
+    cout << string(60, '=') << endl;
+    
+    Blockchain blockchainD(12, HashMode::SHA256D);
+    blockchainD.setObserver(&progress);
+    blockchainD.addBlock("Transaction: Alice -> Bob 100€");
+    blockchainD.addBlock("Transaction: Bob -> Charlie 50€");
+    cout << (blockchainD.isChainValid() ? "✅ La blockchain est VALIDE" : "❌ La blockchain est INVALIDE") << endl;
+    
+    // ========== EXEMPLE 4 : Moteurs de minage ==========
+    testMiningEngines();
+    
     cout << "\n\n╔════════════════════════════════════════════════════════╗" << endl;
     cout << "║            FIN DE L'EXERCICE 2                         ║" << endl;
     cout << "╚════════════════════════════════════════════════════════╝\n" << endl;
@@ -6,16 +6,38 @@
 #include <chrono>
 #include <random>
 #include <algorithm>
-#include "picosha2.h"
+#include "hash256.h"
+#include "block_header.h"
+#include "../common/mining.h"
 
 using namespace std;
 using namespace chrono;
 
 // Fonction pour calculer le hash SHA256
-string sha256(const string& data) {
-    return picosha2::hash256_hex_string(data);
+Hash256 sha256(const string& data) {
+    return sha256Hash(data);
 }
 
+// ========== BLOCS GENESIS CALCULÉS À LA COMPILATION ==========
+// Horodatage fixe ; le nonce PoW a été trouvé hors ligne (20 bits à zéro)
+constexpr char GENESIS_DATA[] = "Genesis Block";
+constexpr char GENESIS_VALIDATOR[] = "System";
+constexpr long long GENESIS_TIMESTAMP = 1735689600000LL;   // 01/01/2025 00:00 UTC
+constexpr uint32_t GENESIS_TARGET_BITS = 20;
+constexpr uint64_t GENESIS_NONCE_POW = 338129;
+
+// Mêmes en-têtes que BlockPoS::header() et BlockPoW::header()
+constexpr Hash256 GENESIS_DATA_HASH = toHash256(picosha2::constexpr_hash256(GENESIS_DATA));
+constexpr Hash256 GENESIS_HASH_POS = constexprHashHeader(
+    BlockHeader{BlockHeader::k_version, 0, Hash256{},
+                constexprHashPair(GENESIS_DATA_HASH, toHash256(picosha2::constexpr_hash256(GENESIS_VALIDATOR))),
+                GENESIS_TIMESTAMP, 0, 0, 0}, HashMode::SHA256);
+constexpr Hash256 GENESIS_HASH_POW = constexprHashHeader(
+    BlockHeader{BlockHeader::k_version, 0, Hash256{}, GENESIS_DATA_HASH, GENESIS_TIMESTAMP,
+                GENESIS_TARGET_BITS, 0, GENESIS_NONCE_POW}, HashMode::SHA256);
+
+static_assert(Target::fromLeadingZeroBits(GENESIS_TARGET_BITS).isMetBy(GENESIS_HASH_POW), "Nonce genesis PoW invalide");
+
 // Classe Validator (Validateur)
 class Validator {
 public:
@@ -36,14 +58,20 @@ public:
 class BlockPoS {
 private:
     int index;
-    string previousHash;
+    Hash256 previousHash;
     string data;
     long long timestamp;
-    string hash;
+    Hash256 hash;
     string validatorName;
     
+    // Bloc genesis : champs et hash fixés à la compilation
+    BlockPoS() : index(0), previousHash(Hash256::zero()), data(GENESIS_DATA), timestamp(GENESIS_TIMESTAMP),
+                 hash(GENESIS_HASH_POS), validatorName(GENESIS_VALIDATOR) {}
+    
 public:
-    BlockPoS(int idx, string prevHash, string d, string validator) 
+    static BlockPoS genesis() { return BlockPoS(); }
+    
+    BlockPoS(int idx, Hash256 prevHash, string d, string validator) 
         : index(idx), previousHash(prevHash), data(d), validatorName(validator) {
         timestamp = duration_cast<milliseconds>(
             system_clock::now().time_since_epoch()
@@ -51,16 +79,20 @@ public:
         hash = calculateHash();
     }
     
-    string calculateHash() const {
-        stringstream ss;
-        ss << index << previousHash << data << timestamp << validatorName;
-        return sha256(ss.str());
+    // En-tête binaire : données et validateur engagés ensemble, pas de nonce
+    BlockHeader header() const {
+        return BlockHeader{BlockHeader::k_version, static_cast<uint32_t>(index), previousHash,
+                           hashPair(sha256(data), sha256(validatorName)), static_cast<uint64_t>(timestamp), 0, 0, 0};
+    }
+    
+    Hash256 calculateHash() const {
+        return header().hash(HashMode::SHA256);
     }
     
     // Getters
-    string getHash() const { return hash; }
+    Hash256 getHash() const { return hash; }
     int getIndex() const { return index; }
-    string getPreviousHash() const { return previousHash; }
+    Hash256 getPreviousHash() const { return previousHash; }
     string getData() const { return data; }
     string getValidator() const { return validatorName; }
     
@@ -70,7 +102,7 @@ public:
         cout << "├─────────────────────────────────────────────────────┤" << endl;
         cout << "│ Données: " << left << setw(42) << data.substr(0, 42) << "│" << endl;
         cout << "│ Validateur: " << setw(39) << validatorName.substr(0, 39) << "│" << endl;
-        cout << "│ Hash: " << hash.substr(0, 32) << "..." << setw(15) << "│" << endl;
+        cout << "│ Hash: " << hash.toHex().substr(0, 32) << "..." << setw(15) << "│" << endl;
         cout << "│ Timestamp: " << setw(40) << timestamp << "│" << endl;
         cout << "└─────────────────────────────────────────────────────┘" << endl;
     }
@@ -122,8 +154,7 @@ public:
         }
         
         // Créer le bloc Genesis
-        BlockPoS genesis(0, "0", "Genesis Block", "System");
-        chain.push_back(genesis);
+        chain.push_back(BlockPoS::genesis());
         cout << "\n✅ Bloc Genesis créé" << endl;
     }
     
@@ -199,54 +230,73 @@ public:
 class BlockPoW {
 private:
     int index;
-    string previousHash;
+    Hash256 previousHash;
     string data;
     long long timestamp;
-    int nonce;
-    string hash;
+    uint32_t target;       // bits de tête à zéro exigés (fixé au minage)
+    uint64_t extraNonce;   // incrémenté si tout l'espace des nonces est épuisé
+    uint64_t nonce;
+    Hash256 hash;
+    
+    // Bloc genesis : déjà miné hors ligne, hash fixé à la compilation
+    BlockPoW() : index(0), previousHash(Hash256::zero()), data(GENESIS_DATA), timestamp(GENESIS_TIMESTAMP),
+                 target(GENESIS_TARGET_BITS), extraNonce(0), nonce(GENESIS_NONCE_POW), hash(GENESIS_HASH_POW) {}
     
 public:
-    BlockPoW(int idx, string prevHash, string d) 
-        : index(idx), previousHash(prevHash), data(d), nonce(0) {
+    static BlockPoW genesis() { return BlockPoW(); }
+    
+    BlockPoW(int idx, Hash256 prevHash, string d) 
+        : index(idx), previousHash(prevHash), data(d), target(0), extraNonce(0), nonce(0) {
         timestamp = duration_cast<milliseconds>(
             system_clock::now().time_since_epoch()
         ).count();
         hash = calculateHash();
     }
     
-    string calculateHash() const {
-        stringstream ss;
-        ss << index << previousHash << data << timestamp << nonce;
-        return sha256(ss.str());
+    BlockHeader header() const {
+        return BlockHeader{BlockHeader::k_version, static_cast<uint32_t>(index), previousHash, sha256(data),
+                           static_cast<uint64_t>(timestamp), target, extraNonce, nonce};
     }
     
-    void mineBlock(int difficulty) {
-        string target(difficulty, '0');
-        while(hash.substr(0, difficulty) != target) {
-            nonce++;
-            hash = calculateHash();
-        }
+    Hash256 calculateHash() const {
+        return header().hash(HashMode::SHA256);
+    }
+    
+    // Difficulté en bits de tête à zéro
+    void mineBlock(uint32_t difficultyBits, parallel::ThreadPool& pool = parallel::defaultPool()) {
+        target = difficultyBits;
+        Target goal = Target::fromLeadingZeroBits(difficultyBits);
+        BlockHeader base = header();
+        mining::MiningResult result = mining::mine([&](unsigned, uint64_t extra) {
+            BlockHeader candidateHeader = base;
+            candidateHeader.extraNonce = extra;
+            HeaderNonceSearch search(candidateHeader, HashMode::SHA256, goal, MiningEngine::Simd);
+            return [search = std::move(search)](uint64_t candidate) mutable {
+                return search.meetsTarget(candidate);
+            };
+        }, mining::MiningLimits(), pool);
+        extraNonce = result.extraNonce;
+        nonce = result.nonce;
+        hash = calculateHash();
     }
     
-    string getHash() const { return hash; }
+    Hash256 getHash() const { return hash; }
 };
 
 // Classe BlockchainPoW (pour comparaison)
 class BlockchainPoW {
 private:
     vector<BlockPoW> chain;
-    int difficulty;
+    uint32_t difficultyBits;
     
 public:
-    BlockchainPoW(int diff) : difficulty(diff) {
-        BlockPoW genesis(0, "0", "Genesis Block");
-        genesis.mineBlock(difficulty);
-        chain.push_back(genesis);
+    BlockchainPoW(uint32_t diffBits) : difficultyBits(diffBits) {
+        chain.push_back(BlockPoW::genesis());
     }
     
     void addBlock(string data) {
         BlockPoW newBlock(chain.size(), chain.back().getHash(), data);
-        newBlock.mineBlock(difficulty);
+        newBlock.mineBlock(difficultyBits);
         chain.push_back(newBlock);
     }
 };
@@ -258,10 +308,10 @@ void comparePoWvsPoS() {
     cout << string(70, '=') << endl;
     
     int numBlocks = 10;
-    int difficulty = 4;
+    uint32_t difficulty = 16;   // bits de tête à zéro
     
     // Test PoW
-    cout << "\n>>> Test avec Proof of Work (difficulté " << difficulty << ") <<<" << endl;
+    cout << "\n>>> Test avec Proof of Work (difficulté " << difficulty << " bits) <<<" << endl;
     auto startPoW = high_resolution_clock::now();
     
     BlockchainPoW blockchainPoW(difficulty);
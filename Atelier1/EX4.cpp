@@ -6,7 +6,12 @@
 #include <chrono>
 #include <random>
 #include <algorithm>
-#include "picosha2.h"
+#include <map>
+#include "hash256.h"
+#include "block_header.h"
+#include "merkle.h"
+#include "sparse_merkle.h"
+#include "../common/mining.h"
 
 using namespace std;
 using namespace chrono;
@@ -15,8 +20,8 @@ using namespace chrono;
 // UTILITAIRES
 // ============================================================================
 
-string sha256(const string& data) {
-    return picosha2::hash256_hex_string(data);
+Hash256 sha256(const string& data) {
+    return sha256Hash(data);
 }
 
 // ============================================================================
@@ -47,37 +52,47 @@ public:
 
 class MerkleTree {
 private:
-    vector<string> leaves;
-    string root;
+    vector<Hash256> leaves;
+    Hash256 root;
     
-    string hashPair(const string& left, const string& right) {
-        return sha256(left + right);
-    }
-    
-    string buildTree(vector<string> hashes) {
-        if(hashes.empty()) return "";
+    Hash256 buildTree(vector<Hash256> hashes) {
+        if(hashes.empty()) return Hash256::zero();
         if(hashes.size() == 1) return hashes[0];
         
-        vector<string> newLevel;
-        for(size_t i = 0; i < hashes.size(); i += 2) {
-            if(i + 1 < hashes.size()) {
-                newLevel.push_back(hashPair(hashes[i], hashes[i+1]));
-            } else {
-                newLevel.push_back(hashPair(hashes[i], hashes[i]));
-            }
-        }
-        return buildTree(newLevel);
+        // Paires hachées en parallèle pour les gros blocs
+        return buildTree(merkleParentLevel(hashes));
     }
     
 public:
     MerkleTree(const vector<Transaction>& transactions) {
+        vector<string> serialized;
         for(const auto& tx : transactions) {
-            leaves.push_back(sha256(tx.toString()));
+            serialized.push_back(tx.toString());
         }
+        leaves = sha256HashBatch(serialized);
         root = buildTree(leaves);
     }
     
-    string getRoot() const { return root; }
+    Hash256 getRoot() const { return root; }
+};
+
+// Bloc en cours d'assemblage : les transactions arrivent une par une et la
+// racine de Merkle est tenue à jour en O(log n) au lieu de reconstruire
+// un MerkleTree complet à chaque arrivée. Même racine que MerkleTree.
+class BlockTemplate {
+private:
+    vector<Transaction> transactions;
+    IncrementalMerkleTree merkle;
+    
+public:
+    void addTransaction(const Transaction& tx) {
+        transactions.push_back(tx);
+        merkle.append(tx.toString());
+    }
+    
+    Hash256 getMerkleRoot() const { return merkle.root(); }
+    const vector<Transaction>& getTransactions() const { return transactions; }
+    size_t size() const { return transactions.size(); }
 };
 
 // ============================================================================
@@ -103,62 +118,122 @@ public:
 // PARTIE 3 : BLOCK
 // ============================================================================
 
+// Bloc genesis calculé à la compilation : horodatage fixe, une transaction
+// unique (sa feuille est donc la racine de Merkle), nonce 0, pas de validateur
+constexpr long long GENESIS_TIMESTAMP = 1735689600000LL;   // 01/01/2025 00:00 UTC
+constexpr Hash256 GENESIS_MERKLE_ROOT = toHash256(picosha2::constexpr_hash256("0SystemNetwork0.00"));
+// Aucun compte au genesis : racine de l'arbre creux vide (256 niveaux). Trop
+// coûteuse à recalculer à la compilation, elle est contrôlée par isChainValid().
+constexpr Hash256 GENESIS_STATE_ROOT = toHash256(picosha2::constexpr_digest_from_hex(
+    "b178c245c947ea7e21ecede07728941a6ab1b706143c06873baff8ebd6de6308"));
+
+// Même en-tête que Block::header() pour le bloc 0 (sans validateur : nom vide)
+constexpr Hash256 GENESIS_CONTENT_ROOT = constexprHashPair(
+    constexprHashPair(GENESIS_MERKLE_ROOT, GENESIS_STATE_ROOT), toHash256(picosha2::constexpr_hash256("")));
+constexpr BlockHeader GENESIS_HEADER = {BlockHeader::k_version, 0, Hash256{}, GENESIS_CONTENT_ROOT,
+                                        GENESIS_TIMESTAMP, 0, 0, 0};
+constexpr Hash256 GENESIS_HASH_SHA256 = constexprHashHeader(GENESIS_HEADER, HashMode::SHA256);
+constexpr Hash256 GENESIS_HASH_SHA256D = constexprHashHeader(GENESIS_HEADER, HashMode::SHA256D);
+
 class Block {
 private:
     int index;
     long long timestamp;
-    string previousHash;
-    string merkleRoot;
-    int nonce;
-    string hash;
+    Hash256 previousHash;
+    Hash256 merkleRoot;
+    Hash256 stateRoot;     // engagement sur les soldes après ce bloc
+    uint32_t target;       // bits de tête à zéro exigés (0 pour PoS)
+    uint64_t extraNonce;   // incrémenté si tout l'espace des nonces est épuisé
+    uint64_t nonce;
+    Hash256 hash;
     vector<Transaction> transactions;
     string validatorName;  // Pour PoS
     bool usedPoW;          // true = PoW, false = PoS
+    HashMode hashMode;     // SHA256 ou double SHA-256
+    
+    explicit Block(HashMode mode)
+        : index(0), timestamp(GENESIS_TIMESTAMP), previousHash(Hash256::zero()), merkleRoot(GENESIS_MERKLE_ROOT),
+          stateRoot(GENESIS_STATE_ROOT), target(0), extraNonce(0), nonce(0), hash(mode == HashMode::SHA256 ? GENESIS_HASH_SHA256 : GENESIS_HASH_SHA256D),
+          transactions(1, Transaction("0", "System", "Network", 0)), validatorName(""), usedPoW(true), hashMode(mode) {}
     
 public:
-    Block(int idx, string prevHash, vector<Transaction> txs, bool usePoW = true, string validator = "") 
-        : index(idx), previousHash(prevHash), transactions(txs), 
-          nonce(0), usedPoW(usePoW), validatorName(validator) {
+    // Bloc genesis : rien n'est haché à l'exécution
+    static Block genesis(HashMode mode) { return Block(mode); }
+    
+    Block(int idx, Hash256 prevHash, vector<Transaction> txs, Hash256 state, bool usePoW = true,
+          string validator = "", HashMode mode = HashMode::SHA256) 
+        : Block(idx, prevHash, txs, MerkleTree(txs).getRoot(), state, usePoW, validator, mode) {}
+    
+    // Bloc issu d'un BlockTemplate : la racine de Merkle est déjà calculée
+    Block(int idx, Hash256 prevHash, const BlockTemplate& blockTemplate, Hash256 state, bool usePoW = true,
+          string validator = "", HashMode mode = HashMode::SHA256) 
+        : Block(idx, prevHash, blockTemplate.getTransactions(), blockTemplate.getMerkleRoot(), state, usePoW,
+                validator, mode) {}
+    
+    Block(int idx, Hash256 prevHash, vector<Transaction> txs, Hash256 root, Hash256 state, bool usePoW,
+          string validator, HashMode mode) 
+        : index(idx), previousHash(prevHash), merkleRoot(root), stateRoot(state), transactions(txs), 
+          target(0), extraNonce(0), nonce(0), usedPoW(usePoW), validatorName(validator), hashMode(mode) {
         
         timestamp = duration_cast<milliseconds>(
             system_clock::now().time_since_epoch()
         ).count();
         
-        // Calculer le Merkle Root
-        MerkleTree tree(transactions);
-        merkleRoot = tree.getRoot();
-        
         hash = calculateHash();
     }
     
-    string calculateHash() const {
-        stringstream ss;
-        ss << index << timestamp << previousHash << merkleRoot << nonce << validatorName;
-        return sha256(ss.str());
+    // Engagement sur le contenu placé dans l'en-tête : racine des
+    // transactions, racine d'état et validateur
+    Hash256 contentRoot() const {
+        return hashPair(hashPair(merkleRoot, stateRoot), sha256(validatorName));
     }
     
-    // Proof of Work
-    void mineBlock(int difficulty) {
-        string target(difficulty, '0');
-        
+    BlockHeader header() const {
+        return BlockHeader{BlockHeader::k_version, static_cast<uint32_t>(index), previousHash, contentRoot(),
+                           static_cast<uint64_t>(timestamp), target, extraNonce, nonce};
+    }
+    
+    Hash256 calculateHash() const {
+        return header().hash(hashMode);
+    }
+    
+    // Proof of Work, sur tous les threads du pool (difficulté en bits de tête à zéro)
+    mining::MiningResult mineBlock(uint32_t difficultyBits, MiningEngine engine = MiningEngine::Simd,
+                                   parallel::ThreadPool& pool = parallel::defaultPool()) {
         auto start = high_resolution_clock::now();
         
-        while(hash.substr(0, difficulty) != target) {
-            nonce++;
-            hash = calculateHash();
-        }
+        target = difficultyBits;
+        Target goal = Target::fromLeadingZeroBits(difficultyBits);
+        BlockHeader base = header();
+        mining::MiningResult result = mining::mine([&](unsigned, uint64_t extra) {
+            // Midstate : seul le bloc final de l'en-tête (nonce + padding) est re-haché
+            BlockHeader candidateHeader = base;
+            candidateHeader.extraNonce = extra;
+            HeaderNonceSearch search(candidateHeader, hashMode, goal, engine);
+            return [search = std::move(search)](uint64_t candidate) mutable {
+                return search.meetsTarget(candidate);
+            };
+        }, mining::MiningLimits(), pool);
+        
+        extraNonce = result.extraNonce;
+        nonce = result.nonce;
+        hash = calculateHash();
         
         auto end = high_resolution_clock::now();
         auto duration = duration_cast<milliseconds>(end - start);
         
         cout << "  ⛏️  Bloc #" << index << " miné (PoW) - Nonce: " << nonce 
-             << " - Temps: " << duration.count() << " ms" << endl;
+             << " - Temps: " << duration.count() << " ms - "
+             << static_cast<unsigned long long>(result.hashRate()) << " H/s (" << result.workers.size()
+             << " thread(s), " << miningEngineToString(engine) << ")" << endl;
+        return result;
     }
     
     // Getters
-    string getHash() const { return hash; }
-    string getPreviousHash() const { return previousHash; }
-    string getMerkleRoot() const { return merkleRoot; }
+    Hash256 getHash() const { return hash; }
+    Hash256 getPreviousHash() const { return previousHash; }
+    Hash256 getMerkleRoot() const { return merkleRoot; }
+    Hash256 getStateRoot() const { return stateRoot; }
     int getIndex() const { return index; }
     bool isPoW() const { return usedPoW; }
     string getValidator() const { return validatorName; }
@@ -175,8 +250,9 @@ public:
             cout << "│ Nonce: " << setw(48) << nonce << "│" << endl;
         }
         cout << "│ Transactions: " << setw(41) << transactions.size() << "│" << endl;
-        cout << "│ Merkle Root: " << merkleRoot.substr(0, 32) << "..." << setw(9) << "│" << endl;
-        cout << "│ Hash: " << hash.substr(0, 32) << "..." << setw(16) << "│" << endl;
+        cout << "│ Merkle Root: " << merkleRoot.toHex().substr(0, 32) << "..." << setw(9) << "│" << endl;
+        cout << "│ State Root: " << stateRoot.toHex().substr(0, 32) << "..." << setw(10) << "│" << endl;
+        cout << "│ Hash: " << hash.toHex().substr(0, 32) << "..." << setw(16) << "│" << endl;
         cout << "└─────────────────────────────────────────────────────────┘" << endl;
         
         for(const auto& tx : transactions) {
@@ -193,7 +269,9 @@ class Blockchain {
 private:
     vector<Block> chain;
     vector<Validator> validators;
-    int difficulty;
+    uint32_t difficultyBits;   // bits de tête à zéro exigés (PoW)
+    HashMode hashMode;
+    MiningEngine engine;
     mt19937 rng;
     
     // Statistiques
@@ -201,6 +279,50 @@ private:
     long long totalPoSTime;
     int powBlocks;
     int posBlocks;
+    unsigned long long totalPoWHashes;
+    double totalPoWSeconds;
+    
+    // État des comptes après le dernier bloc et son engagement
+    map<string, double> balances;
+    SparseMerkleTree state;
+    
+    // Historique des hashes de blocs (preuves compactes pour clients légers)
+    MerkleMountainRange history;
+    
+    void appendBlock(const Block& block) {
+        chain.push_back(block);
+        history.append(block.getHash());
+    }
+    
+    static Hash256 accountKey(const string& name) {
+        return sha256(name);
+    }
+    
+    static string formatBalance(double balance) {
+        stringstream ss;
+        ss << fixed << setprecision(2) << balance;
+        return ss.str();
+    }
+    
+    // Applique les transactions d'un bloc aux soldes ; seuls les comptes
+    // touchés sont mis à jour dans l'arbre creux (un seul lot par bloc)
+    static Hash256 applyTransactions(const vector<Transaction>& transactions, map<string, double>& balances,
+                                     SparseMerkleTree& state) {
+        map<string, bool> touched;
+        for(const auto& tx : transactions) {
+            balances[tx.sender] -= tx.amount;
+            balances[tx.receiver] += tx.amount;
+            touched[tx.sender] = true;
+            touched[tx.receiver] = true;
+        }
+        vector<pair<Hash256, Hash256>> leaves;
+        for(const auto& account : touched) {
+            Hash256 key = accountKey(account.first);
+            leaves.push_back(make_pair(key, SparseMerkleTree::leafHash(key, formatBalance(balances[account.first]))));
+        }
+        state.update(leaves);
+        return state.root();
+    }
     
     Validator& selectValidator() {
         double totalStake = 0;
@@ -223,8 +345,9 @@ private:
     }
     
 public:
-    Blockchain(int diff = 3) : difficulty(diff), totalPoWTime(0), totalPoSTime(0), 
-                                 powBlocks(0), posBlocks(0) {
+    Blockchain(uint32_t diffBits = 12, HashMode mode = HashMode::SHA256, MiningEngine miningEngine = MiningEngine::Simd) 
+        : difficultyBits(diffBits), hashMode(mode), engine(miningEngine), totalPoWTime(0), totalPoSTime(0), 
+          powBlocks(0), posBlocks(0), totalPoWHashes(0), totalPoWSeconds(0) {
         rng.seed(time(nullptr));
         
         // Initialiser les validateurs
@@ -234,13 +357,9 @@ public:
         validators.push_back(Validator("Dave", 200));
         
         // Bloc Genesis
-        vector<Transaction> genesisTx;
-        genesisTx.push_back(Transaction("0", "System", "Network", 0));
-        
-        Block genesis(0, "0", genesisTx, true, "");
-        chain.push_back(genesis);
+        appendBlock(Block::genesis(hashMode));
         
-        cout << "🔗 Blockchain initialisée (Difficulté PoW: " << difficulty << ")" << endl;
+        cout << "🔗 Blockchain initialisée (Difficulté PoW: " << difficultyBits << " bits)" << endl;
     }
     
     Block getLastBlock() const {
@@ -249,17 +368,28 @@ public:
     
     // Ajouter un bloc avec PoW
     void addBlockPoW(vector<Transaction> transactions) {
+        BlockTemplate blockTemplate;
+        for(const auto& tx : transactions) {
+            blockTemplate.addTransaction(tx);
+        }
+        addBlockPoW(blockTemplate);
+    }
+    
+    void addBlockPoW(const BlockTemplate& blockTemplate) {
         cout << "\n📦 Ajout d'un bloc avec Proof of Work..." << endl;
         
         auto start = high_resolution_clock::now();
         
-        Block newBlock(chain.size(), getLastBlock().getHash(), transactions, true, "");
-        newBlock.mineBlock(difficulty);
+        Hash256 stateRoot = applyTransactions(blockTemplate.getTransactions(), balances, state);
+        Block newBlock(chain.size(), getLastBlock().getHash(), blockTemplate, stateRoot, true, "", hashMode);
+        mining::MiningResult result = newBlock.mineBlock(difficultyBits, engine);
+        totalPoWHashes += result.totalHashes();
+        totalPoWSeconds += result.seconds;
         
         auto end = high_resolution_clock::now();
         auto duration = duration_cast<milliseconds>(end - start);
         
-        chain.push_back(newBlock);
+        appendBlock(newBlock);
         totalPoWTime += duration.count();
         powBlocks++;
         
@@ -276,12 +406,13 @@ public:
         cout << "  🎲 Validateur sélectionné: " << validator.name 
              << " (Stake: " << validator.stake << ")" << endl;
         
-        Block newBlock(chain.size(), getLastBlock().getHash(), transactions, false, validator.name);
+        Hash256 stateRoot = applyTransactions(transactions, balances, state);
+        Block newBlock(chain.size(), getLastBlock().getHash(), transactions, stateRoot, false, validator.name, hashMode);
         
         auto end = high_resolution_clock::now();
         auto duration = duration_cast<milliseconds>(end - start);
         
-        chain.push_back(newBlock);
+        appendBlock(newBlock);
         validator.blocksValidated++;
         totalPoSTime += duration.count();
         posBlocks++;
@@ -290,10 +421,32 @@ public:
     }
     
     bool isChainValid() const {
+        // Rejoue les transactions depuis un état vide pour contrôler les racines d'état
+        map<string, double> replayBalances;
+        SparseMerkleTree replayState;
+        if(chain[0].getStateRoot() != replayState.root()) {
+            return false;
+        }
+        
+        // La MMR doit engager exactement les hashes de la chaîne
+        MerkleMountainRange replayHistory;
+        for(const auto& block : chain) {
+            replayHistory.append(block.getHash());
+        }
+        if(replayHistory.root() != history.root()) {
+            return false;
+        }
+        
+        Target goal = Target::fromLeadingZeroBits(difficultyBits);
         for(size_t i = 1; i < chain.size(); i++) {
             const Block& current = chain[i];
             const Block& previous = chain[i-1];
             
+            // Vérifier l'engagement sur les soldes
+            if(current.getStateRoot() != applyTransactions(current.getTransactions(), replayBalances, replayState)) {
+                return false;
+            }
+            
             // Vérifier le hash
             if(current.getHash() != current.calculateHash()) {
                 return false;
@@ -306,8 +459,7 @@ public:
             
             // Vérifier la difficulté pour PoW
             if(current.isPoW()) {
-                string target(difficulty, '0');
-                if(current.getHash().substr(0, difficulty) != target) {
+                if(!goal.isMetBy(current.getHash())) {
                     return false;
                 }
             }
@@ -344,7 +496,10 @@ public:
             cout << "║  ─────────────────────────────────────────────────────  ║" << endl;
             cout << "║  Temps total: " << setw(38) << totalPoWTime << " ms ║" << endl;
             cout << "║  Temps moyen par bloc: " << setw(29) << fixed << setprecision(2) << avgPoW << " ms ║" << endl;
-            cout << "║  Difficulté: " << setw(41) << difficulty << " ║" << endl;
+            cout << "║  Difficulté (bits): " << setw(34) << difficultyBits << " ║" << endl;
+            cout << "║  Moteur: " << setw(45) << miningEngineToString(engine) << " ║" << endl;
+            cout << "║  Débit moyen: " << setw(36)
+                 << static_cast<unsigned long long>(totalPoWSeconds > 0 ? totalPoWHashes / totalPoWSeconds : 0) << " H/s ║" << endl;
             cout << "║                                                          ║" << endl;
         }
         
@@ -381,6 +536,28 @@ public:
     }
     
     int getChainLength() const { return chain.size(); }
+    
+    // Preuve du solde d'un compte (ou de son absence) contre la racine
+    // d'état du dernier bloc ; `leaf` reçoit la feuille attendue (zéro si absent)
+    SparseMerkleProof proveAccount(const string& name, Hash256& leaf) const {
+        leaf = state.get(accountKey(name));
+        return state.prove(accountKey(name));
+    }
+    
+    Hash256 getStateRoot() const { return chain.back().getStateRoot(); }
+    
+    // Preuve en O(log n) qu'un ancien bloc appartient à la chaîne actuelle
+    MountainRangeProof proveBlock(size_t index) const {
+        return history.prove(index);
+    }
+    
+    Hash256 getHistoryRoot() const { return history.root(); }
+    Hash256 getBlockHash(size_t index) const { return chain[index].getHash(); }
+    
+    double getBalance(const string& name) const {
+        auto it = balances.find(name);
+        return (it == balances.end()) ? 0 : it->second;
+    }
 };
 
 // ============================================================================
@@ -393,7 +570,7 @@ int main() {
     cout << "╚═══════════════════════════════════════════════════════════╝\n" << endl;
     
     // Créer la blockchain
-    Blockchain blockchain(3);
+    Blockchain blockchain(12);
     
     // ========== PARTIE 2 : Ajouter des blocs avec PoW ==========
     cout << "\n\n" << string(65, '=') << endl;
@@ -414,6 +591,21 @@ int main() {
     tx3.push_back(Transaction("tx005", "Alice", "Charlie", 75.0));
     blockchain.addBlockPoW(tx3);
     
+    // Assemblage incrémental : la racine suit chaque transaction reçue
+    cout << "\n📥 Assemblage incrémental d'un bloc:" << endl;
+    BlockTemplate pending;
+    vector<Transaction> arrivals = {
+        Transaction("tx011", "Eve", "Alice", 12.0),
+        Transaction("tx012", "Alice", "Eve", 8.0),
+        Transaction("tx013", "Bob", "Eve", 5.0)
+    };
+    for(const auto& tx : arrivals) {
+        pending.addTransaction(tx);
+        cout << "  " << pending.size() << " transaction(s) - Merkle Root: "
+             << pending.getMerkleRoot().toHex().substr(0, 32) << "..." << endl;
+    }
+    blockchain.addBlockPoW(pending);
+    
     // ========== PARTIE 3 : Ajouter des blocs avec PoS ==========
     cout << "\n\n" << string(65, '=') << endl;
     cout << "PARTIE 3 : Ajout de blocs avec Proof of Stake" << endl;
@@ -442,6 +634,25 @@ int main() {
     cout << string(65, '=') << endl;
     cout << (blockchain.isChainValid() ? "✅ La blockchain est VALIDE" : "❌ La blockchain est INVALIDE") << endl;
     
+    // Engagement sur les soldes : preuve d'inclusion et preuve d'absence
+    cout << "\n🏦 Racine d'état: " << blockchain.getStateRoot().toHex().substr(0, 32) << "..." << endl;
+    for(const string& account : {string("Alice"), string("Mallory")}) {
+        Hash256 leaf;
+        SparseMerkleProof proof = blockchain.proveAccount(account, leaf);
+        bool valid = verifySparseMerkleProof(blockchain.getStateRoot(), sha256(account), leaf, proof);
+        cout << "  " << account << ": " << (leaf.isZero() ? "compte absent" : "solde " + to_string(blockchain.getBalance(account)))
+             << " - preuve " << (leaf.isZero() ? "d'absence " : "d'inclusion ") << (valid ? "valide" : "INVALIDE")
+             << " (" << proof.siblings.size() << " frères non vides)" << endl;
+    }
+    
+    // Client léger : appartenance d'un ancien bloc sans parcourir la chaîne
+    MountainRangeProof blockProof = blockchain.proveBlock(1);
+    bool blockValid = verifyMountainRangeProof(blockchain.getBlockHash(1), blockProof, blockchain.getHistoryRoot());
+    cout << "\n🏔️  Racine MMR: " << blockchain.getHistoryRoot().toHex().substr(0, 32) << "..." << endl;
+    cout << "  Bloc #1 dans la chaîne de " << blockchain.getChainLength() << " blocs - preuve "
+         << (blockValid ? "valide" : "INVALIDE") << " (" << blockProof.siblings.size() << " frères + "
+         << blockProof.peaks.size() << " sommets)" << endl;
+    
     // ========== PARTIE 4 : Analyse comparative ==========
     blockchain.displayStats();
     
@@ -0,0 +1,227 @@
+#ifndef BLOCK_HEADER_H
+#define BLOCK_HEADER_H
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include "hash256.h"
+
+// En-tête de bloc binaire à disposition fixe (100 octets, entiers en
+// petit-boutiste, hashes en 32 octets bruts) :
+//
+//   offset  taille  champ
+//        0       4  version
+//        4       4  height        (index du bloc)
+//        8      32  previousHash
+//       40      32  merkleRoot    (engagement sur le contenu du bloc)
+//       72       8  timestamp     (ms depuis l'époque Unix)
+//       80       4  target        (bits de tête à zéro exigés)
+//       84       8  extraNonce
+//       92       8  nonce
+//
+// Les 64 premiers octets (premier bloc SHA-256) ne changent pas pendant le
+// minage : ils sont compressés une seule fois. Le reste, nonce compris,
+// tient avec le padding dans une seule compression.
+struct BlockHeader {
+    static const size_t k_size = 100;
+    static const size_t k_nonce_offset = 92;
+    static const size_t k_tail_offset = 64;        // début du second bloc SHA-256
+    static const uint32_t k_version = 1;
+
+    uint32_t version;
+    uint32_t height;
+    Hash256 previousHash;
+    Hash256 merkleRoot;
+    uint64_t timestamp;
+    uint32_t target;
+    uint64_t extraNonce;
+    uint64_t nonce;
+
+    struct Bytes {
+        picosha2::byte_t data[k_size];
+    };
+
+    static HASH256_CONSTEXPR void storeLE(picosha2::byte_t* out, uint64_t value, size_t width) {
+        for(size_t i = 0; i < width; i++) {
+            out[i] = static_cast<picosha2::byte_t>(value >> (8 * i));
+        }
+    }
+
+    static uint64_t loadLE(const picosha2::byte_t* in, size_t width) {
+        uint64_t value = 0;
+        for(size_t i = width; i-- > 0; ) {
+            value = (value << 8) | in[i];
+        }
+        return value;
+    }
+
+    HASH256_CONSTEXPR Bytes encode() const {
+        Bytes out = {};
+        storeLE(out.data, version, 4);
+        storeLE(out.data + 4, height, 4);
+        for(size_t i = 0; i < 32; i++) {
+            out.data[8 + i] = previousHash.bytes[i];
+            out.data[40 + i] = merkleRoot.bytes[i];
+        }
+        storeLE(out.data + 72, timestamp, 8);
+        storeLE(out.data + 80, target, 4);
+        storeLE(out.data + 84, extraNonce, 8);
+        storeLE(out.data + k_nonce_offset, nonce, 8);
+        return out;
+    }
+
+    // Retourne false si `size` n'est pas la taille d'un en-tête ou si la
+    // version est inconnue
+    static bool decode(const picosha2::byte_t* data, size_t size, BlockHeader& header) {
+        if(size != k_size || loadLE(data, 4) != k_version) {
+            return false;
+        }
+        header.version = static_cast<uint32_t>(loadLE(data, 4));
+        header.height = static_cast<uint32_t>(loadLE(data + 4, 4));
+        std::memcpy(header.previousHash.bytes, data + 8, 32);
+        std::memcpy(header.merkleRoot.bytes, data + 40, 32);
+        header.timestamp = loadLE(data + 72, 8);
+        header.target = static_cast<uint32_t>(loadLE(data + 80, 4));
+        header.extraNonce = loadLE(data + 84, 8);
+        header.nonce = loadLE(data + k_nonce_offset, 8);
+        return true;
+    }
+
+    // Hash de l'en-tête, sans allocation
+    Hash256 hash(HashMode mode) const {
+        Bytes bytes = encode();
+        Hash256 h;
+        if(mode == HashMode::SHA256) {
+            picosha2::calc_hash(bytes.data, bytes.data + k_size, h.bytes);
+        } else {
+            picosha2::calc_hash256d(bytes.data, bytes.data + k_size, h.bytes);
+        }
+        return h;
+    }
+};
+
+static_assert(BlockHeader::k_nonce_offset + 8 == BlockHeader::k_size, "Le nonce doit terminer l'en-tête");
+static_assert(BlockHeader::k_size - BlockHeader::k_tail_offset + 9 <= 64,
+              "La fin de l'en-tête et son padding doivent tenir dans un bloc SHA-256");
+static_assert(BlockHeader::k_tail_offset % 64 == 0 && (BlockHeader::k_nonce_offset - BlockHeader::k_tail_offset) % 4 == 0,
+              "Le balayage SIMD suppose un préfixe en blocs entiers et un nonce aligné sur un mot");
+
+// Minage : premier bloc de l'en-tête compressé une fois, puis un hash par
+// nonce sur la fin de l'en-tête (36 octets) où seul le nonce est réécrit.
+// Un objet par thread.
+class HeaderMidstate {
+private:
+    picosha2::hash256_one_by_one midstate;
+    picosha2::byte_t tail[BlockHeader::k_size - BlockHeader::k_tail_offset];
+    HashMode mode;
+
+public:
+    HeaderMidstate(const BlockHeader& header, HashMode hashMode) : mode(hashMode) {
+        BlockHeader::Bytes bytes = header.encode();
+        midstate.process(bytes.data, bytes.data + BlockHeader::k_tail_offset);
+        std::memcpy(tail, bytes.data + BlockHeader::k_tail_offset, sizeof(tail));
+    }
+
+    Hash256 hash(uint64_t nonce) {
+        BlockHeader::storeLE(tail + (BlockHeader::k_nonce_offset - BlockHeader::k_tail_offset), nonce, 8);
+        Hash256 h;
+        if(mode == HashMode::SHA256) {
+            picosha2::calc_hash_from_midstate(midstate, tail, tail + sizeof(tail), h.bytes);
+        } else {
+            picosha2::calc_hash256d_from_midstate(midstate, tail, tail + sizeof(tail), h.bytes);
+        }
+        return h;
+    }
+};
+
+// Moteurs de minage : un hash par nonce (HeaderMidstate, SHA-NI si présent)
+// ou balayage SIMD de 8 (AVX2) / 16 (AVX-512) nonces consécutifs par passe
+enum class MiningEngine {
+    Scalar,
+    Simd
+};
+
+// Sans AVX2, le balayage SIMD retombe sur le moteur scalaire
+inline MiningEngine resolveMiningEngine(MiningEngine engine) {
+    return picosha2::hash256_batch_lane_width() > 1 ? engine : MiningEngine::Scalar;
+}
+
+inline std::string miningEngineToString(MiningEngine engine) {
+    if(resolveMiningEngine(engine) == MiningEngine::Scalar) {
+        return "scalaire";
+    }
+    return "SIMD x" + std::to_string(picosha2::hash256_batch_lane_width());
+}
+
+// Test de la cible pour les nonces d'un en-tête, avec le moteur choisi.
+// En SIMD, une passe évalue les nonces consécutifs à partir du premier
+// demandé (planning des messages et premières rondes indépendants du nonce
+// précalculés, rejet sur le premier mot du digest) ; les nonces suivants
+// lisent le résultat de la passe. Seul le moteur retenu est préparé : un
+// objet est créé par thread et par extra-nonce.
+class HeaderNonceSearch {
+private:
+    BlockHeader blockHeader;
+    HashMode hashMode;
+    std::unique_ptr<HeaderMidstate> midstate;        // moteur scalaire
+    std::unique_ptr<picosha2::nonce_sweep> sweep;    // moteur SIMD
+    Target goal;
+    bool hasPass;
+    uint64_t passFirst;
+    uint32_t passMask;
+
+    static picosha2::nonce_sweep* makeSweep(const BlockHeader& header, HashMode mode) {
+        BlockHeader::Bytes bytes = header.encode();
+        picosha2::hash256_one_by_one prefix;
+        prefix.process(bytes.data, bytes.data + BlockHeader::k_tail_offset);
+        return new picosha2::nonce_sweep(prefix, bytes.data + BlockHeader::k_tail_offset,
+                                         BlockHeader::k_size - BlockHeader::k_tail_offset,
+                                         BlockHeader::k_nonce_offset - BlockHeader::k_tail_offset,
+                                         mode == HashMode::SHA256D);
+    }
+
+public:
+    HeaderNonceSearch(const BlockHeader& header, HashMode mode, const Target& target, MiningEngine engine)
+        : blockHeader(header), hashMode(mode), goal(target), hasPass(false), passFirst(0), passMask(0) {
+        if(resolveMiningEngine(engine) == MiningEngine::Simd) {
+            sweep.reset(makeSweep(header, mode));
+        } else {
+            midstate.reset(new HeaderMidstate(header, mode));
+        }
+    }
+
+    bool meetsTarget(uint64_t nonce) {
+        if(!sweep) {
+            return goal.isMetBy(midstate->hash(nonce));
+        }
+        uint64_t lane = nonce - passFirst;
+        if(!hasPass || lane >= sweep->lanes()) {
+            passFirst = nonce;
+            passMask = sweep->sweep(nonce, goal.words);
+            hasPass = true;
+            lane = 0;
+        }
+        return (passMask >> lane) & 1;
+    }
+
+    // Hash d'un nonce isolé (affichage), recalculé depuis l'en-tête
+    Hash256 hash(uint64_t nonce) const {
+        BlockHeader header = blockHeader;
+        header.nonce = nonce;
+        return header.hash(hashMode);
+    }
+};
+
+#if __cplusplus >= 201402L
+// Équivalent à la compilation de BlockHeader::hash() (blocs genesis)
+constexpr Hash256 constexprHashHeader(const BlockHeader& header, HashMode mode) {
+    BlockHeader::Bytes bytes = header.encode();
+    picosha2::constexpr_digest digest = picosha2::constexpr_hash256(bytes.data, BlockHeader::k_size);
+    if(mode == HashMode::SHA256D) {
+        digest = picosha2::constexpr_hash256(digest.bytes, picosha2::k_digest_size);
+    }
+    return toHash256(digest);
+}
+#endif
+
+#endif
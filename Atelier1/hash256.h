@@ -0,0 +1,280 @@
+#ifndef HASH256_H
+#define HASH256_H
+
+#include <string>
+#include <vector>
+#include <cstring>
+#include <type_traits>
+#include <algorithm>
+#include <functional>
+#include "picosha2.h"
+#include "../common/hex.h"
+#include "../common/parallel.h"
+
+// Les méthodes utiles aux constantes calculées à la compilation
+// ne peuvent être constexpr qu'à partir de C++14 (boucles)
+#if __cplusplus >= 201402L
+#define HASH256_CONSTEXPR constexpr
+#else
+#define HASH256_CONSTEXPR
+#endif
+
+// Empreinte SHA-256 binaire (32 octets), copiable comme une valeur.
+// L'hexadécimal ne sert qu'à l'affichage.
+struct Hash256 {
+    picosha2::byte_t bytes[picosha2::k_digest_size];
+
+    static Hash256 zero() {
+        Hash256 h;
+        std::memset(h.bytes, 0, sizeof(h.bytes));
+        return h;
+    }
+
+    // Hash nul si la chaîne ne fait pas 64 caractères hexadécimaux
+    static Hash256 fromHex(const std::string& hexString) {
+        Hash256 h;
+        if(hexString.size() != 2 * sizeof(h.bytes) || !hex::decode(hexString.data(), sizeof(h.bytes), h.bytes)) {
+            return zero();
+        }
+        return h;
+    }
+    
+    std::string toHex() const {
+        return picosha2::bytes_to_hex_string(bytes, bytes + sizeof(bytes));
+    }
+
+    bool isZero() const {
+        return *this == zero();
+    }
+
+    // Mot de 32 bits n° i, lu en gros-boutiste (mot 0 = poids fort)
+    HASH256_CONSTEXPR uint32_t word(size_t i) const {
+        return static_cast<uint32_t>(bytes[4 * i]) << 24 | static_cast<uint32_t>(bytes[4 * i + 1]) << 16
+             | static_cast<uint32_t>(bytes[4 * i + 2]) << 8 | static_cast<uint32_t>(bytes[4 * i + 3]);
+    }
+
+    bool operator==(const Hash256& other) const {
+        return std::memcmp(bytes, other.bytes, sizeof(bytes)) == 0;
+    }
+
+    bool operator!=(const Hash256& other) const {
+        return !(*this == other);
+    }
+
+    bool operator<(const Hash256& other) const {
+        return std::memcmp(bytes, other.bytes, sizeof(bytes)) < 0;
+    }
+};
+
+// Clé de table de hachage : les octets d'un SHA-256 sont déjà uniformes,
+// les 8 premiers suffisent
+namespace std {
+template<>
+struct hash<Hash256> {
+    size_t operator()(const Hash256& h) const {
+        uint64_t prefix;
+        std::memcpy(&prefix, h.bytes, sizeof(prefix));
+        return static_cast<size_t>(prefix);
+    }
+};
+}
+
+static_assert(sizeof(Hash256) == 32, "Hash256 doit occuper exactement 32 octets");
+static_assert(std::is_trivially_copyable<Hash256>::value, "Hash256 doit rester trivialement copiable");
+
+// Cible de preuve de travail : entier de 256 bits en 8 mots, poids fort en
+// premier. Un hash, lu comme un entier gros-boutiste, est valide s'il est
+// inférieur ou égal à la cible. La comparaison se fait mot à mot et s'arrête
+// au premier mot différent, en pratique presque toujours le premier.
+struct Target {
+    uint32_t words[8];
+
+    // Cible exigeant `bits` bits de tête à zéro (granularité d'un bit :
+    // chaque bit de plus double le travail attendu, un zéro hexadécimal
+    // vaut 4 bits)
+    static HASH256_CONSTEXPR Target fromLeadingZeroBits(uint32_t bits) {
+        Target t = {};
+        for(uint32_t i = 0; i < 8; i++) {
+            uint32_t first = 32 * i;
+            t.words[i] = bits >= first + 32 ? 0 : bits <= first ? 0xffffffffu : 0xffffffffu >> (bits - first);
+        }
+        return t;
+    }
+
+    HASH256_CONSTEXPR bool isMetBy(const Hash256& h) const {
+        for(size_t i = 0; i < 8; i++) {
+            uint32_t w = h.word(i);
+            if(w != words[i]) {
+                return w < words[i];
+            }
+        }
+        return true;
+    }
+
+    std::string toHex() const {
+        picosha2::byte_t bytes[32];
+        for(size_t i = 0; i < 8; i++) {
+            picosha2::detail::store_be32(words[i], bytes + 4 * i);
+        }
+        return picosha2::bytes_to_hex_string(bytes, bytes + sizeof(bytes));
+    }
+};
+
+// SHA-256 d'une chaîne quelconque
+inline Hash256 sha256Hash(const std::string& data) {
+    Hash256 h;
+    picosha2::calc_hash(data.begin(), data.end(), h.bytes);
+    return h;
+}
+
+// SHA-256 de (préfixe absorbé par `midstate`) + `tail`
+inline Hash256 sha256Hash(const picosha2::hash256_one_by_one& midstate, const std::string& tail) {
+    Hash256 h;
+    picosha2::calc_hash_from_midstate(midstate, tail.begin(), tail.end(), h.bytes);
+    return h;
+}
+
+// En dessous de ces tailles, le coût de répartition sur le pool dépasse le gain
+static const size_t k_parallel_batch_threshold = 1024;     // messages
+static const size_t k_parallel_merkle_threshold = 2048;    // paires de noeuds
+
+// SHA-256 de plusieurs chaînes indépendantes, par lots SIMD, écrits dans
+// hashes[0, data.size()). Répartis sur le pool de threads pour les gros volumes.
+inline void sha256HashBatch(const std::vector<std::string>& data, Hash256* hashes,
+                            parallel::ThreadPool& pool = parallel::defaultPool()) {
+    std::vector<const picosha2::byte_t*> messages(data.size());
+    std::vector<size_t> lengths(data.size());
+    for(size_t i = 0; i < data.size(); i++) {
+        messages[i] = reinterpret_cast<const picosha2::byte_t*>(data[i].data());
+        lengths[i] = data[i].size();
+    }
+    parallel::parallelFor(data.size(), k_parallel_batch_threshold, [&](size_t begin, size_t end) {
+        picosha2::hash256_batch(&messages[begin], &lengths[begin], end - begin,
+                                reinterpret_cast<picosha2::byte_t*>(hashes + begin));
+    }, pool);
+}
+
+inline std::vector<Hash256> sha256HashBatch(const std::vector<std::string>& data,
+                                            parallel::ThreadPool& pool = parallel::defaultPool()) {
+    std::vector<Hash256> hashes(data.size());
+    if(!data.empty()) {
+        sha256HashBatch(data, &hashes[0], pool);
+    }
+    return hashes;
+}
+
+// Double SHA-256 (sha256d), hash d'en-tête de Bitcoin
+inline Hash256 sha256dHash(const std::string& data) {
+    Hash256 h;
+    picosha2::calc_hash256d(data.begin(), data.end(), h.bytes);
+    return h;
+}
+
+inline Hash256 sha256dHash(const picosha2::hash256_one_by_one& midstate, const std::string& tail) {
+    Hash256 h;
+    picosha2::calc_hash256d_from_midstate(midstate, tail.begin(), tail.end(), h.bytes);
+    return h;
+}
+
+// ========== MODE DE HACHAGE DES EN-TÊTES ==========
+enum class HashMode {
+    SHA256,
+    SHA256D
+};
+
+inline std::string hashModeToString(HashMode mode) {
+    return (mode == HashMode::SHA256) ? "SHA256" : "SHA256D";
+}
+
+inline Hash256 hashHeader(const std::string& header, HashMode mode) {
+    return (mode == HashMode::SHA256) ? sha256Hash(header) : sha256dHash(header);
+}
+
+inline Hash256 hashHeader(const picosha2::hash256_one_by_one& midstate, const std::string& tail, HashMode mode) {
+    return (mode == HashMode::SHA256) ? sha256Hash(midstate, tail) : sha256dHash(midstate, tail);
+}
+
+// Hash de plusieurs en-têtes : premier tour par lots SIMD, second tour fusionné
+inline std::vector<Hash256> hashHeaderBatch(const std::vector<std::string>& headers, HashMode mode) {
+    std::vector<Hash256> hashes = sha256HashBatch(headers);
+    if(mode == HashMode::SHA256D) {
+        for(auto& h : hashes) {
+            Hash256 first = h;
+            picosha2::hash256_of_digest(first.bytes, h.bytes);
+        }
+    }
+    return hashes;
+}
+
+#if __cplusplus >= 201402L
+// ========== CALCULS À LA COMPILATION (C++14) ==========
+// Hashes des blocs genesis calculés par le compilateur
+constexpr Hash256 toHash256(const picosha2::constexpr_digest& digest) {
+    Hash256 h = {};
+    for(size_t i = 0; i < sizeof(h.bytes); i++) {
+        h.bytes[i] = digest.bytes[i];
+    }
+    return h;
+}
+
+// Équivalent à la compilation de hashPair()
+constexpr Hash256 constexprHashPair(const Hash256& left, const Hash256& right) {
+    picosha2::byte_t pair[64] = {};
+    for(size_t i = 0; i < 32; i++) {
+        pair[i] = left.bytes[i];
+        pair[32 + i] = right.bytes[i];
+    }
+    return toHash256(picosha2::constexpr_hash256(pair, sizeof(pair)));
+}
+#endif
+
+// Noeud parent d'un arbre de Merkle : SHA-256 des 64 octets left || right.
+// Le message tient dans un bloc ; le bloc de padding est constant.
+inline Hash256 hashPair(const Hash256& left, const Hash256& right) {
+    static const picosha2::byte_t padding[64] = {
+        0x80, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x02, 0x00   // 512 bits
+    };
+    picosha2::byte_t block[64];
+    std::memcpy(block, left.bytes, 32);
+    std::memcpy(block + 32, right.bytes, 32);
+
+    picosha2::word_t state[8];
+    std::copy(picosha2::detail::initial_message_digest, picosha2::detail::initial_message_digest + 8, state);
+    picosha2::detail::hash256_blocks(block, 1, state);
+    picosha2::detail::hash256_blocks(padding, 1, state);
+
+    Hash256 h;
+    for(size_t i = 0; i < 8; i++) {
+        picosha2::detail::store_be32(static_cast<std::uint32_t>(state[i]), h.bytes + 4 * i);
+    }
+    return h;
+}
+
+// Niveau parent d'un niveau de Merkle de `count` noeuds, écrit dans
+// parents[0, (count + 1) / 2) (dernier noeud dupliqué si impair).
+// Les paires sont indépendantes : au-delà du seuil, elles sont hachées
+// en parallèle sur le pool.
+inline void merkleParentLevel(const Hash256* level, size_t count, Hash256* parents,
+                              parallel::ThreadPool& pool = parallel::defaultPool()) {
+    parallel::parallelFor((count + 1) / 2, k_parallel_merkle_threshold, [&](size_t begin, size_t end) {
+        for(size_t i = begin; i < end; i++) {
+            const Hash256& left = level[2 * i];
+            const Hash256& right = (2 * i + 1 < count) ? level[2 * i + 1] : left;
+            parents[i] = hashPair(left, right);
+        }
+    }, pool);
+}
+
+inline std::vector<Hash256> merkleParentLevel(const std::vector<Hash256>& level,
+                                              parallel::ThreadPool& pool = parallel::defaultPool()) {
+    std::vector<Hash256> parents((level.size() + 1) / 2);
+    if(!level.empty()) {
+        merkleParentLevel(&level[0], level.size(), &parents[0], pool);
+    }
+    return parents;
+}
+
+#endif
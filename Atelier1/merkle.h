@@ -0,0 +1,398 @@
+#ifndef MERKLE_H
+#define MERKLE_H
+
+#include <vector>
+#include <string>
+#include <utility>
+#include <fstream>
+#include "hash256.h"
+
+// Preuve d'inclusion : les frères du chemin, de la feuille vers la racine.
+// Le côté du frère à chaque niveau se déduit de l'index de la feuille
+// (bit h à 0 : le noeud courant est à gauche au niveau h).
+struct MerkleProof {
+    size_t leafIndex;
+    std::vector<Hash256> siblings;
+
+    bool siblingOnLeft(size_t level) const {
+        return (leafIndex >> level) & 1;
+    }
+};
+
+// Vérifie une preuve : un seul hashPair par niveau, dans le bon ordre
+inline bool verifyMerkleProof(const Hash256& leaf, const MerkleProof& proof, const Hash256& root) {
+    Hash256 current = leaf;
+    for(size_t level = 0; level < proof.siblings.size(); level++) {
+        current = proof.siblingOnLeft(level) ? hashPair(proof.siblings[level], current)
+                                             : hashPair(current, proof.siblings[level]);
+    }
+    return current == root;
+}
+
+static const size_t k_parallel_proof_threshold = 256;     // preuves
+
+// Vérifie beaucoup de preuves contre une même racine. Niveau par niveau,
+// les paires (64 octets) de toutes les preuves encore actives sont hachées
+// ensemble par les noyaux SIMD de picosha2 ; les tranches de preuves sont
+// réparties sur le pool. results[i] vaut 1 si la preuve i est valide ;
+// tout est rejeté si leaves et proofs n'ont pas la même taille.
+inline std::vector<char> verifyMerkleProofs(const std::vector<Hash256>& leaves,
+                                            const std::vector<MerkleProof>& proofs, const Hash256& root,
+                                            parallel::ThreadPool& pool = parallel::defaultPool()) {
+    std::vector<char> results(proofs.size(), 0);
+    if(leaves.size() != proofs.size()) {
+        return results;
+    }
+    parallel::parallelFor(proofs.size(), k_parallel_proof_threshold, [&](size_t begin, size_t end) {
+        size_t count = end - begin;
+        std::vector<Hash256> current(leaves.begin() + begin, leaves.begin() + end);
+        std::vector<picosha2::byte_t> pairs(64 * count);
+        std::vector<const picosha2::byte_t*> messages(count);
+        std::vector<size_t> lengths(count, 64);
+        std::vector<Hash256> parents(count);
+        std::vector<size_t> active(count);
+
+        for(size_t level = 0; ; level++) {
+            size_t n = 0;
+            for(size_t i = 0; i < count; i++) {
+                const MerkleProof& proof = proofs[begin + i];
+                if(level >= proof.siblings.size()) {
+                    continue;
+                }
+                picosha2::byte_t* pair = &pairs[64 * n];
+                bool left = proof.siblingOnLeft(level);
+                std::memcpy(pair, left ? proof.siblings[level].bytes : current[i].bytes, 32);
+                std::memcpy(pair + 32, left ? current[i].bytes : proof.siblings[level].bytes, 32);
+                messages[n] = pair;
+                active[n++] = i;
+            }
+            if(n == 0) {
+                break;
+            }
+            picosha2::hash256_batch(&messages[0], &lengths[0], n, reinterpret_cast<picosha2::byte_t*>(&parents[0]));
+            for(size_t k = 0; k < n; k++) {
+                current[active[k]] = parents[k];
+            }
+        }
+
+        for(size_t i = 0; i < count; i++) {
+            results[begin + i] = (current[i] == root);
+        }
+    }, pool);
+    return results;
+}
+
+// Multipreuve : inclusion de plusieurs feuilles d'un même arbre. Chaque
+// noeud nécessaire n'apparaît qu'une fois ; les frères déjà calculables à
+// partir des feuilles demandées ne sont pas transmis. `nodes` suit l'ordre
+// de reconstruction : niveau par niveau, de gauche à droite.
+struct MerkleMultiProof {
+    size_t leafCount;                  // nombre de feuilles de l'arbre
+    std::vector<size_t> leafIndices;   // triés, sans doublon
+    std::vector<Hash256> nodes;
+};
+
+// Reconstruit la racine à partir des feuilles demandées (dans l'ordre de
+// proof.leafIndices) et la compare à `root`. Un hashPair par noeud de
+// l'union des chemins.
+inline bool verifyMerkleMultiProof(const std::vector<Hash256>& leaves, const MerkleMultiProof& proof,
+                                   const Hash256& root) {
+    if(leaves.empty() || leaves.size() != proof.leafIndices.size()) {
+        return false;
+    }
+    std::vector<std::pair<size_t, Hash256>> current;
+    for(size_t i = 0; i < leaves.size(); i++) {
+        size_t index = proof.leafIndices[i];
+        if(index >= proof.leafCount || (i > 0 && index <= proof.leafIndices[i - 1])) {
+            return false;
+        }
+        current.push_back(std::make_pair(index, leaves[i]));
+    }
+
+    size_t used = 0;
+    for(size_t levelSize = proof.leafCount; levelSize > 1; levelSize = (levelSize + 1) / 2) {
+        std::vector<std::pair<size_t, Hash256>> next;
+        for(size_t i = 0; i < current.size(); i++) {
+            size_t index = current[i].first;
+            const Hash256& hash = current[i].second;
+            Hash256 parent;
+            if(index % 2 == 1) {
+                // Le frère gauche n'est pas demandé (sinon il aurait été apparié)
+                if(used >= proof.nodes.size()) {
+                    return false;
+                }
+                parent = hashPair(proof.nodes[used++], hash);
+            } else if(i + 1 < current.size() && current[i + 1].first == index + 1) {
+                parent = hashPair(hash, current[++i].second);
+            } else if(index + 1 >= levelSize) {
+                parent = hashPair(hash, hash);     // dernier noeud, dupliqué
+            } else {
+                if(used >= proof.nodes.size()) {
+                    return false;
+                }
+                parent = hashPair(hash, proof.nodes[used++]);
+            }
+            next.push_back(std::make_pair(index / 2, parent));
+        }
+        current.swap(next);
+    }
+    return used == proof.nodes.size() && current[0].second == root;
+}
+
+// Arbre de Merkle incrémental (ajout seulement).
+// Seule la frontière droite est conservée : frontier[h] est la racine du
+// dernier sous-arbre complet de 2^h feuilles pas encore apparié (bit h
+// du nombre de feuilles). append() et root() sont en O(log n), et root()
+// applique la même règle que buildTree : un noeud sans frère est
+// apparié avec lui-même.
+class IncrementalMerkleTree {
+private:
+    std::vector<Hash256> frontier;
+    unsigned long long count;
+
+public:
+    IncrementalMerkleTree() : count(0) {}
+
+    void append(const Hash256& leaf) {
+        // Propagation comme une retenue binaire
+        Hash256 node = leaf;
+        size_t height = 0;
+        while((count >> height) & 1) {
+            node = hashPair(frontier[height], node);
+            height++;
+        }
+        if(frontier.size() <= height) {
+            frontier.resize(height + 1);
+        }
+        frontier[height] = node;
+        count++;
+    }
+
+    void append(const std::string& transaction) {
+        append(sha256Hash(transaction));
+    }
+
+    Hash256 root() const {
+        if(count == 0) {
+            return Hash256::zero();
+        }
+        // Le noeud le plus à droite part du plus petit sous-arbre complet ;
+        // à chaque niveau il a soit un frère gauche dans la frontière,
+        // soit aucun frère (il est alors dupliqué)
+        size_t low = 0;
+        while(!((count >> low) & 1)) {
+            low++;
+        }
+        Hash256 node = frontier[low];
+        for(size_t height = low; (1ULL << height) < count; height++) {
+            bool hasLeftSibling = height > low && ((count >> height) & 1);
+            node = hasLeftSibling ? hashPair(frontier[height], node) : hashPair(node, node);
+        }
+        return node;
+    }
+
+    unsigned long long size() const { return count; }
+    bool empty() const { return count == 0; }
+};
+
+// Preuve d'appartenance à une Merkle Mountain Range : le chemin de la
+// feuille jusqu'au sommet de sa montagne, puis les autres sommets (de
+// gauche à droite). Le nombre de feuilles fixe la forme de la chaîne.
+struct MountainRangeProof {
+    unsigned long long leafIndex;
+    unsigned long long leafCount;
+    std::vector<Hash256> siblings;     // de la feuille vers le sommet
+    std::vector<Hash256> peaks;        // sommets des autres montagnes
+};
+
+// Merkle Mountain Range (ajout seulement) : une montagne (arbre parfait)
+// par bit à 1 du nombre de feuilles, des plus hautes à gauche vers les plus
+// basses à droite. nodes[h][k] est la racine des feuilles [k*2^h, (k+1)*2^h) :
+// tout noeud calculé reste valable, un ajout coûte en moyenne un hashPair
+// et la preuve de n'importe quelle ancienne feuille est en O(log n).
+class MerkleMountainRange {
+private:
+    std::vector<std::vector<Hash256>> nodes;
+    unsigned long long count;
+
+    static int highestBit(unsigned long long value) {
+        int bit = -1;
+        while(value) {
+            value >>= 1;
+            bit++;
+        }
+        return bit;
+    }
+
+    // Sommets ensachés de droite à gauche : racine = H(p0, H(p1, ... H(pk-1, pk)))
+    static Hash256 bagPeaks(const std::vector<Hash256>& peaks) {
+        if(peaks.empty()) {
+            return Hash256::zero();
+        }
+        Hash256 root = peaks.back();
+        for(size_t i = peaks.size() - 1; i-- > 0; ) {
+            root = hashPair(peaks[i], root);
+        }
+        return root;
+    }
+
+    friend bool verifyMountainRangeProof(const Hash256&, const MountainRangeProof&, const Hash256&);
+
+public:
+    MerkleMountainRange() : count(0) {}
+
+    // Ajoute une feuille et retourne son index
+    unsigned long long append(const Hash256& leaf) {
+        if(nodes.empty()) {
+            nodes.resize(1);
+        }
+        nodes[0].push_back(leaf);
+        // Fusion des deux dernières montagnes de même hauteur
+        for(size_t h = 0; nodes[h].size() % 2 == 0; h++) {
+            if(nodes.size() <= h + 1) {
+                nodes.resize(h + 2);
+            }
+            const std::vector<Hash256>& level = nodes[h];
+            nodes[h + 1].push_back(hashPair(level[level.size() - 2], level.back()));
+        }
+        return count++;
+    }
+
+    std::vector<Hash256> peaks() const {
+        std::vector<Hash256> result;
+        for(int h = highestBit(count); h >= 0; h--) {
+            if((count >> h) & 1) {
+                result.push_back(nodes[h][(count >> h) - 1]);
+            }
+        }
+        return result;
+    }
+
+    Hash256 root() const {
+        return bagPeaks(peaks());
+    }
+
+    // Preuve de la feuille `index` contre la racine actuelle
+    MountainRangeProof prove(unsigned long long index) const {
+        MountainRangeProof proof;
+        proof.leafIndex = index;
+        proof.leafCount = count;
+        unsigned long long start = 0;
+        for(int h = highestBit(count); h >= 0; h--) {
+            if(!((count >> h) & 1)) {
+                continue;
+            }
+            unsigned long long size = 1ULL << h;
+            if(index >= start && index < start + size) {
+                for(int level = 0; level < h; level++) {
+                    proof.siblings.push_back(nodes[level][(index >> level) ^ 1]);
+                }
+            } else {
+                proof.peaks.push_back(nodes[h][(start >> h)]);
+            }
+            start += size;
+        }
+        return proof;
+    }
+
+    const Hash256& leaf(unsigned long long index) const { return nodes[0][index]; }
+    unsigned long long size() const { return count; }
+    bool empty() const { return count == 0; }
+};
+
+// Vérifie qu'une feuille appartient à la MMR de racine `root` : remonte
+// jusqu'au sommet de sa montagne, le replace parmi les autres sommets
+// puis ensache. O(log n) hashPair.
+inline bool verifyMountainRangeProof(const Hash256& leaf, const MountainRangeProof& proof, const Hash256& root) {
+    unsigned long long count = proof.leafCount;
+    if(proof.leafIndex >= count) {
+        return false;
+    }
+    std::vector<Hash256> peaks;
+    size_t used = 0;
+    unsigned long long start = 0;
+    for(int h = MerkleMountainRange::highestBit(count); h >= 0; h--) {
+        if(!((count >> h) & 1)) {
+            continue;
+        }
+        unsigned long long size = 1ULL << h;
+        if(proof.leafIndex >= start && proof.leafIndex < start + size) {
+            if(proof.siblings.size() != static_cast<size_t>(h)) {
+                return false;
+            }
+            Hash256 current = leaf;
+            for(int level = 0; level < h; level++) {
+                current = ((proof.leafIndex >> level) & 1) ? hashPair(proof.siblings[level], current)
+                                                          : hashPair(current, proof.siblings[level]);
+            }
+            peaks.push_back(current);
+        } else {
+            if(used >= proof.peaks.size()) {
+                return false;
+            }
+            peaks.push_back(proof.peaks[used++]);
+        }
+        start += size;
+    }
+    return used == proof.peaks.size() && MerkleMountainRange::bagPeaks(peaks) == root;
+}
+
+// Transactions hachées par paquets de cette taille dans les calculs en flux
+static const size_t k_stream_chunk_size = 4096;
+
+// Racine de Merkle d'un flux de transactions (chaînes) sans le garder en
+// mémoire : les feuilles sont hachées par paquets (lots SIMD) puis versées
+// dans la frontière d'un IncrementalMerkleTree. Mémoire : un paquet plus
+// log2(n) hashes. Même racine que MerkleTree::getRoot().
+template<typename InIter>
+Hash256 streamingMerkleRoot(InIter first, InIter last) {
+    IncrementalMerkleTree tree;
+    std::vector<std::string> chunk;
+    chunk.reserve(k_stream_chunk_size);
+    while(first != last) {
+        chunk.clear();
+        while(chunk.size() < k_stream_chunk_size && first != last) {
+            chunk.push_back(*first);
+            ++first;
+        }
+        for(const Hash256& leaf : sha256HashBatch(chunk)) {
+            tree.append(leaf);
+        }
+    }
+    return tree.root();
+}
+
+// Itérateur de lignes d'un flux (une transaction par ligne, sans le '\n')
+class LineIterator {
+private:
+    std::istream* in;
+    std::string line;
+
+    void advance() {
+        if(in && !std::getline(*in, line)) {
+            in = nullptr;
+        }
+    }
+
+public:
+    LineIterator() : in(nullptr) {}
+    explicit LineIterator(std::istream& stream) : in(&stream) { advance(); }
+
+    const std::string& operator*() const { return line; }
+    LineIterator& operator++() { advance(); return *this; }
+    bool operator==(const LineIterator& other) const { return in == other.in; }
+    bool operator!=(const LineIterator& other) const { return in != other.in; }
+};
+
+// Racine de Merkle d'un fichier texte, une transaction par ligne.
+// Retourne false si le fichier ne peut pas être lu.
+inline bool streamingMerkleRootFromFile(const std::string& path, Hash256& root) {
+    std::ifstream file(path.c_str(), std::ios::binary);
+    if(!file) {
+        return false;
+    }
+    root = streamingMerkleRoot(LineIterator(file), LineIterator());
+    return !file.bad();
+}
+
+#endif
@@ -0,0 +1,249 @@
+#ifndef MERKLE_FILE_H
+#define MERKLE_FILE_H
+
+// Arbre de Merkle stocké sur disque, pour des ensembles de transactions trop
+// gros pour la mémoire. Le fichier contient un en-tête de 32 octets puis
+// tous les noeuds de 32 octets, niveau par niveau (feuilles d'abord, racine
+// en dernier) : la même disposition que le tampon de MerkleTree, donc les
+// mêmes racines et les mêmes preuves. Le fichier est projeté en mémoire
+// (mmap) : seules les pages utiles sont chargées, et le noyau peut les
+// évincer, la mémoire du processus reste bornée.
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include "merkle.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define MERKLE_FILE_HAS_MMAP 1
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+static const size_t k_file_merkle_window = 1 << 16;       // parents calculés par passe
+
+class FileMerkleTree {
+private:
+    // En-tête : signature puis nombre de feuilles (ordre d'octets de la machine)
+    static const size_t k_header_size = 32;
+    static const char* magic() { return "MERKLE01"; }
+
+    const unsigned char* mapping;
+    size_t mappedSize;
+    std::vector<size_t> levelOffsets;
+
+    // Offsets des niveaux, comme MerkleTree::allocate
+    static std::vector<size_t> computeOffsets(size_t count) {
+        std::vector<size_t> offsets(1, 0);
+        if(count == 0) {
+            return offsets;
+        }
+        size_t size = count;
+        offsets.push_back(size);
+        while(size > 1) {
+            size = (size + 1) / 2;
+            offsets.push_back(offsets.back() + size);
+        }
+        return offsets;
+    }
+
+    const Hash256* nodes() const {
+        return reinterpret_cast<const Hash256*>(mapping + k_header_size);
+    }
+
+    size_t levelCount() const { return levelOffsets.size() - 1; }
+    size_t levelSize(size_t level) const { return levelOffsets[level + 1] - levelOffsets[level]; }
+    const Hash256& node(size_t level, size_t i) const { return nodes()[levelOffsets[level] + i]; }
+
+#ifdef MERKLE_FILE_HAS_MMAP
+    // Lance l'écriture asynchrone des pages de [first, last) (msync exige
+    // une adresse de début alignée sur une page)
+    static void flushRange(const Hash256* first, const Hash256* last) {
+        uintptr_t pageSize = static_cast<uintptr_t>(::sysconf(_SC_PAGESIZE));
+        uintptr_t begin = reinterpret_cast<uintptr_t>(first) & ~(pageSize - 1);
+        uintptr_t end = reinterpret_cast<uintptr_t>(last);
+        ::msync(reinterpret_cast<void*>(begin), end - begin, MS_ASYNC);
+    }
+
+    // Niveaux supérieurs calculés en place dans le fichier projeté, par
+    // fenêtres de k_file_merkle_window parents ; chaque fenêtre terminée est
+    // rendue au noyau pour écriture (les pages restent évinçables)
+    static bool buildLevels(int fd, size_t count) {
+        std::vector<size_t> offsets = computeOffsets(count);
+        size_t size = k_header_size + offsets.back() * sizeof(Hash256);
+        if(::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+            return false;
+        }
+        void* map = ::mmap(0, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if(map == MAP_FAILED) {
+            return false;
+        }
+        Hash256* all = reinterpret_cast<Hash256*>(static_cast<unsigned char*>(map) + k_header_size);
+        for(size_t level = 0; level + 2 < offsets.size(); level++) {
+            size_t levelSize = offsets[level + 1] - offsets[level];
+            Hash256* children = all + offsets[level];
+            Hash256* parents = all + offsets[level + 1];
+            size_t parentCount = (levelSize + 1) / 2;
+            for(size_t begin = 0; begin < parentCount; begin += k_file_merkle_window) {
+                size_t end = std::min(parentCount, begin + k_file_merkle_window);
+                size_t childEnd = std::min(levelSize, 2 * end);
+                merkleParentLevel(children + 2 * begin, childEnd - 2 * begin, parents + begin);
+                flushRange(parents + begin, parents + end);
+            }
+        }
+        bool ok = ::msync(map, size, MS_SYNC) == 0;
+        ::munmap(map, size);
+        return ok;
+    }
+#endif
+
+public:
+    FileMerkleTree() : mapping(nullptr), mappedSize(0), levelOffsets(1, 0) {}
+    ~FileMerkleTree() { close(); }
+
+    FileMerkleTree(const FileMerkleTree&) = delete;
+    FileMerkleTree& operator=(const FileMerkleTree&) = delete;
+
+    // Construit le fichier `path` à partir d'un flux de transactions : les
+    // feuilles sont hachées par paquets (lots SIMD) et écrites à la suite,
+    // puis les niveaux supérieurs sont calculés dans le fichier projeté.
+    // Retourne false en cas d'erreur d'écriture ou sans mmap.
+    template<typename InIter>
+    static bool build(const std::string& path, InIter first, InIter last) {
+#ifdef MERKLE_FILE_HAS_MMAP
+        std::FILE* file = std::fopen(path.c_str(), "wb");
+        if(!file) {
+            return false;
+        }
+        unsigned char header[k_header_size] = {0};
+        std::memcpy(header, magic(), 8);
+        bool ok = std::fwrite(header, 1, sizeof(header), file) == sizeof(header);
+
+        uint64_t count = 0;
+        std::vector<std::string> chunk;
+        chunk.reserve(k_stream_chunk_size);
+        while(ok && first != last) {
+            chunk.clear();
+            while(chunk.size() < k_stream_chunk_size && first != last) {
+                chunk.push_back(*first);
+                ++first;
+            }
+            std::vector<Hash256> leaves = sha256HashBatch(chunk);
+            ok = std::fwrite(&leaves[0], sizeof(Hash256), leaves.size(), file) == leaves.size();
+            count += leaves.size();
+        }
+        if(ok) {
+            // Le nombre de feuilles n'est connu qu'à la fin du flux
+            ok = std::fseek(file, 8, SEEK_SET) == 0 && std::fwrite(&count, sizeof(count), 1, file) == 1;
+        }
+        ok = (std::fclose(file) == 0) && ok;
+        if(!ok) {
+            return false;
+        }
+
+        int fd = ::open(path.c_str(), O_RDWR);
+        if(fd < 0) {
+            return false;
+        }
+        ok = buildLevels(fd, static_cast<size_t>(count));
+        ::close(fd);
+        return ok;
+#else
+        (void)path; (void)first; (void)last;
+        return false;
+#endif
+    }
+
+    // Fichier texte (une transaction par ligne) -> arbre sur disque
+    static bool buildFromFile(const std::string& transactionsPath, const std::string& treePath) {
+        std::ifstream input(transactionsPath.c_str(), std::ios::binary);
+        if(!input) {
+            return false;
+        }
+        return build(treePath, LineIterator(input), LineIterator()) && !input.bad();
+    }
+
+    // Ouvre un arbre déjà construit, en lecture seule. Vérifie la signature
+    // et que la taille correspond au nombre de feuilles annoncé.
+    bool open(const std::string& path) {
+        close();
+#ifdef MERKLE_FILE_HAS_MMAP
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if(fd < 0) {
+            return false;
+        }
+        struct stat st;
+        if(::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < k_header_size) {
+            ::close(fd);
+            return false;
+        }
+        size_t size = static_cast<size_t>(st.st_size);
+        void* map = ::mmap(0, size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if(map == MAP_FAILED) {
+            return false;
+        }
+        const unsigned char* bytes = static_cast<const unsigned char*>(map);
+        uint64_t count;
+        std::memcpy(&count, bytes + 8, sizeof(count));
+        std::vector<size_t> offsets = computeOffsets(count <= size / sizeof(Hash256) ? static_cast<size_t>(count) : 0);
+        if(std::memcmp(bytes, magic(), 8) != 0 || count > size / sizeof(Hash256)
+           || size != k_header_size + offsets.back() * sizeof(Hash256)) {
+            ::munmap(map, size);
+            return false;
+        }
+        // Les preuves lisent quelques noeuds épars
+        ::madvise(map, size, MADV_RANDOM);
+        mapping = bytes;
+        mappedSize = size;
+        levelOffsets.swap(offsets);
+        return true;
+#else
+        (void)path;
+        return false;
+#endif
+    }
+
+    void close() {
+#ifdef MERKLE_FILE_HAS_MMAP
+        if(mapping) {
+            ::munmap(const_cast<unsigned char*>(mapping), mappedSize);
+        }
+#endif
+        mapping = nullptr;
+        mappedSize = 0;
+        levelOffsets.assign(1, 0);
+    }
+
+    bool isOpen() const { return mapping != nullptr; }
+    size_t getLeafCount() const { return levelOffsets.size() < 2 ? 0 : levelOffsets[1]; }
+
+    Hash256 getRoot() const {
+        return getLeafCount() == 0 ? Hash256::zero() : nodes()[levelOffsets.back() - 1];
+    }
+
+    const Hash256& getLeaf(size_t index) const { return node(0, index); }
+
+    // Même preuve que MerkleTree::generateProof : frère i ^ 1, ou le noeud
+    // lui-même s'il est dupliqué
+    MerkleProof generateProof(size_t leafIndex) const {
+        MerkleProof proof;
+        proof.leafIndex = leafIndex;
+        if(leafIndex >= getLeafCount()) {
+            return proof;
+        }
+        size_t index = leafIndex;
+        for(size_t level = 0; level + 1 < levelCount(); level++) {
+            size_t sibling = index ^ 1;
+            proof.siblings.push_back(node(level, sibling < levelSize(level) ? sibling : index));
+            index /= 2;
+        }
+        return proof;
+    }
+};
+
+#endif
@@ -31,6 +31,14 @@ THE SOFTWARE.
 #include <string>
 #include <algorithm>
 #include <iterator>
+#include <sstream>
+#include <cstdint>
+#include <cstring>
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define PICOSHA2_HAS_X86_SIMD 1
+#include <immintrin.h>
+#include <cpuid.h>
+#endif
 
 namespace picosha2
 {
@@ -51,7 +59,7 @@ inline word_t mask_32bit(word_t x)
 	return x & 0xffffffff;
 }
 
-const word_t add_constant[64] = {
+constexpr word_t add_constant[64] = {
 	0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
 	0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
 	0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
@@ -62,7 +70,7 @@ const word_t add_constant[64] = {
 	0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
 };
 
-const word_t initial_message_digest[8] = {
+constexpr word_t initial_message_digest[8] = {
 	0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
 };
 
@@ -106,6 +114,20 @@ inline word_t ssig1(word_t x)
 	return rotr(x, 17) ^ rotr(x, 19) ^ shr(x, 10);
 }
 
+inline std::uint32_t load_be32(const byte_t* p)
+{
+	return static_cast<std::uint32_t>(p[0]) << 24 | static_cast<std::uint32_t>(p[1]) << 16 |
+		static_cast<std::uint32_t>(p[2]) << 8 | static_cast<std::uint32_t>(p[3]);
+}
+
+inline void store_be32(std::uint32_t x, byte_t* p)
+{
+	p[0] = static_cast<byte_t>(x >> 24);
+	p[1] = static_cast<byte_t>(x >> 16);
+	p[2] = static_cast<byte_t>(x >> 8);
+	p[3] = static_cast<byte_t>(x);
+}
+
 template<typename RaIter>
 void hash256_block(RaIter first, RaIter last, word_t* message_digest)
 {
@@ -152,27 +174,139 @@ void hash256_block(RaIter first, RaIter last, word_t* message_digest)
 	}
 }
 
+#ifdef PICOSHA2_HAS_X86_SIMD
+// SHA extensions (SHA-NI): two rounds per _mm_sha256rnds2_epu32, state kept
+// as ABEF/CDGH register pairs.
+#define PICOSHA2_SHA_NI __attribute__((target("sha,sse4.1,ssse3")))
+
+PICOSHA2_SHA_NI inline void hash256_blocks_sha_ni(const byte_t* data, std::size_t nblocks, std::uint32_t* state)
+{
+	const __m128i byte_swap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+	__m128i tmp = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state)), 0xB1);
+	__m128i state1 = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state + 4)), 0x1B);
+	__m128i state0 = _mm_alignr_epi8(tmp, state1, 8);
+	state1 = _mm_blend_epi16(state1, tmp, 0xF0);
+
+	for (; nblocks > 0; --nblocks, data += 64) {
+		__m128i abef_save = state0;
+		__m128i cdgh_save = state1;
+		__m128i msgs[4];
+		for (std::size_t i = 0; i < 4; ++i) {
+			msgs[i] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 16 * i)), byte_swap);
+		}
+		for (std::size_t i = 0; i < 16; ++i) {
+			__m128i msg = _mm_add_epi32(msgs[i & 3], _mm_set_epi32(
+				static_cast<int>(add_constant[4 * i + 3]), static_cast<int>(add_constant[4 * i + 2]),
+				static_cast<int>(add_constant[4 * i + 1]), static_cast<int>(add_constant[4 * i])));
+			state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+			state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(msg, 0x0E));
+			if (i < 12) {
+				// schedule words 4i+16 .. 4i+19 replace words 4i .. 4i+3
+				__m128i next = _mm_sha256msg1_epu32(msgs[i & 3], msgs[(i + 1) & 3]);
+				next = _mm_add_epi32(next, _mm_alignr_epi8(msgs[(i + 3) & 3], msgs[(i + 2) & 3], 4));
+				msgs[i & 3] = _mm_sha256msg2_epu32(next, msgs[(i + 3) & 3]);
+			}
+		}
+		state0 = _mm_add_epi32(state0, abef_save);
+		state1 = _mm_add_epi32(state1, cdgh_save);
+	}
+
+	tmp = _mm_shuffle_epi32(state0, 0x1B);
+	state1 = _mm_shuffle_epi32(state1, 0xB1);
+	state0 = _mm_blend_epi16(tmp, state1, 0xF0);
+	state1 = _mm_alignr_epi8(state1, tmp, 8);
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(state), state0);
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(state + 4), state1);
+}
+
+inline bool cpu_has_sha_ni()
+{
+	static const bool supported = [] {
+		unsigned int eax, ebx, ecx, edx;
+		if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx) || !(ecx & bit_SSE4_1) || !(ecx & bit_SSSE3)) {
+			return false;
+		}
+		return __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) && (ebx & bit_SHA) != 0;
+	}();
+	return supported;
+}
+#else
+inline bool cpu_has_sha_ni() { return false; }
+#endif
+
+// Set to false to force the portable compression (e.g. to cross-check it).
+inline bool& sha_ni_allowed()
+{
+	static bool allowed = true;
+	return allowed;
+}
+
+// Compresses `nblocks` consecutive 64-byte blocks into message_digest,
+// using SHA-NI when available and the portable hash256_block otherwise.
+inline void hash256_blocks(const byte_t* data, std::size_t nblocks, word_t* message_digest)
+{
+#ifdef PICOSHA2_HAS_X86_SIMD
+	if (sha_ni_allowed() && cpu_has_sha_ni()) {
+		std::uint32_t state[8];
+		std::copy(message_digest, message_digest + 8, state);
+		hash256_blocks_sha_ni(data, nblocks, state);
+		std::copy(state, state + 8, message_digest);
+		return;
+	}
+#endif
+	for (std::size_t i = 0; i < nblocks; ++i) {
+		hash256_block(data + 64 * i, data + 64 * (i + 1), message_digest);
+	}
+}
+
 } // namespace detail
 
+namespace detail
+{
+
+// "00" .. "ff": each byte yields its two characters with a single lookup.
+static const char hex_pairs[513] =
+	"000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f"
+	"202122232425262728292a2b2c2d2e2f303132333435363738393a3b3c3d3e3f"
+	"404142434445464748494a4b4c4d4e4f505152535455565758595a5b5c5d5e5f"
+	"606162636465666768696a6b6c6d6e6f707172737475767778797a7b7c7d7e7f"
+	"808182838485868788898a8b8c8d8e8f909192939495969798999a9b9c9d9e9f"
+	"a0a1a2a3a4a5a6a7a8a9aaabacadaeafb0b1b2b3b4b5b6b7b8b9babbbcbdbebf"
+	"c0c1c2c3c4c5c6c7c8c9cacbcccdcecfd0d1d2d3d4d5d6d7d8d9dadbdcdddedf"
+	"e0e1e2e3e4e5e6e7e8e9eaebecedeeeff0f1f2f3f4f5f6f7f8f9fafbfcfdfeff";
+
+// Encodes up to 64 bytes at a time into a local buffer, appended in one go.
 template<typename InIter>
-void output_hex(InIter first, InIter last, std::ostream& os)
+void append_hex(InIter first, InIter last, std::string& hex_str)
 {
-	os.setf(std::ios::hex, std::ios::basefield);
+	char hex[128];
 	while (first != last) {
-		os.width(2);
-		os.fill('0');
-		os << static_cast<unsigned int>(*first);
-		++first;
+		std::size_t n = 0;
+		while (n < sizeof(hex) / 2 && first != last) {
+			std::memcpy(hex + 2 * n, hex_pairs + 2 * static_cast<byte_t>(*first), 2);
+			++n;
+			++first;
+		}
+		hex_str.append(hex, 2 * n);
 	}
-	os.setf(std::ios::dec, std::ios::basefield);
+}
+
+} // namespace detail
+
+template<typename InIter>
+void output_hex(InIter first, InIter last, std::ostream& os)
+{
+	std::string hex_str;
+	detail::append_hex(first, last, hex_str);
+	os << hex_str;
 }
 
 template<typename InIter>
 void bytes_to_hex_string(InIter first, InIter last, std::string& hex_str)
 {
-	std::ostringstream oss;
-	output_hex(first, last, oss);
-	hex_str.assign(oss.str());
+	hex_str.clear();
+	detail::append_hex(first, last, hex_str);
 }
 
 template<typename InContainer>
@@ -207,22 +341,86 @@ public:
 
 	void init()
 	{
-		buffer_.clear();
+		buffer_size_ = 0;
+		data_length_ = 0;
 		std::copy(detail::initial_message_digest, detail::initial_message_digest + 8, message_digest_);
 	}
 
+	// Contiguous input: full blocks are compressed straight from the
+	// caller's memory, only a partial block is copied into buffer_.
+	void process(const byte_t* first, const byte_t* last)
+	{
+		process_contiguous(first, static_cast<std::size_t>(last - first));
+	}
+
+	void process(byte_t* first, byte_t* last)
+	{
+		process_contiguous(first, static_cast<std::size_t>(last - first));
+	}
+
+	void process(const char* first, const char* last)
+	{
+		process_contiguous(reinterpret_cast<const byte_t*>(first), static_cast<std::size_t>(last - first));
+	}
+
+	void process(char* first, char* last)
+	{
+		process(static_cast<const char*>(first), static_cast<const char*>(last));
+	}
+
+	void process(std::string::const_iterator first, std::string::const_iterator last)
+	{
+		if(first != last){
+			process(&*first, &*first + (last - first));
+		}
+	}
+
+	void process(std::string::iterator first, std::string::iterator last)
+	{
+		process(std::string::const_iterator(first), std::string::const_iterator(last));
+	}
+
+	void process(std::vector<byte_t>::const_iterator first, std::vector<byte_t>::const_iterator last)
+	{
+		if(first != last){
+			process(&*first, &*first + (last - first));
+		}
+	}
+
+	void process(std::vector<byte_t>::iterator first, std::vector<byte_t>::iterator last)
+	{
+		process(std::vector<byte_t>::const_iterator(first), std::vector<byte_t>::const_iterator(last));
+	}
+
+	// Any other iterator: bytes go through the 64-byte buffer one by one.
 	template<typename RaIter>
 	void process(RaIter first, RaIter last)
 	{
-		add_to_buffer(first, last);
-		process_buffer();
+		while(first != last){
+			buffer_[buffer_size_++] = static_cast<byte_t>(*first++);
+			++data_length_;
+			if(buffer_size_ == 64){
+				detail::hash256_blocks(buffer_, 1, message_digest_);
+				buffer_size_ = 0;
+			}
+		}
 	}
 
 	void finish()
 	{
-		byte_t len[8];
-		pad_buffer(len);
-		process(len, len + 8);
+		unsigned long long msg_bits = data_length_ * 8;
+		buffer_[buffer_size_++] = 0x80;
+		if(buffer_size_ > 56){
+			std::fill(buffer_ + buffer_size_, buffer_ + 64, 0);
+			detail::hash256_blocks(buffer_, 1, message_digest_);
+			buffer_size_ = 0;
+		}
+		std::fill(buffer_ + buffer_size_, buffer_ + 56, 0);
+		for(int i = 0; i < 8; ++i){
+			buffer_[56 + i] = detail::mask_8bit(static_cast<byte_t>(msg_bits >> (56 - 8 * i)));
+		}
+		detail::hash256_blocks(buffer_, 1, message_digest_);
+		buffer_size_ = 0;
 	}
 
 	template<typename OutIter>
@@ -235,45 +433,55 @@ public:
 		}
 	}
 
-private:
-	void add_to_buffer(const byte_t* first, const byte_t* last)
+	// Midstate access for kernels that finish the hash themselves: the
+	// compression state is only meaningful when no partial block is buffered.
+	bool block_aligned()const
 	{
-		std::copy(first, last, std::back_inserter(buffer_));
+		return buffer_size_ == 0;
 	}
 
-	template<typename RaIter>
-	void add_to_buffer(RaIter first, RaIter last)
+	unsigned long long length()const
 	{
-		while(first != last){
-			buffer_.push_back(*first++);
-		}
+		return data_length_;
 	}
 
-	void process_buffer()
+	void get_state(std::uint32_t* state)const
 	{
-		std::vector<byte_t>::iterator first = buffer_.begin();
-		while(buffer_.end() - first >= 64){
-			detail::hash256_block(first, first + 64, message_digest_);
-			first += 64;
+		for(std::size_t i = 0; i < 8; ++i){
+			state[i] = static_cast<std::uint32_t>(message_digest_[i]);
 		}
-		buffer_.erase(buffer_.begin(), first);
 	}
 
-	void pad_buffer(byte_t* len)
+private:
+	void process_contiguous(const byte_t* data, std::size_t size)
 	{
-		std::size_t msg_bits = buffer_.size() * 8;
-		for(int i = 0; i < 8; ++i){
-			len[i] = detail::mask_8bit(static_cast<byte_t>(msg_bits >> (56 - 8 * i)));
+		data_length_ += size;
+		if(buffer_size_ > 0){
+			std::size_t take = std::min(size, 64 - buffer_size_);
+			std::copy(data, data + take, buffer_ + buffer_size_);
+			buffer_size_ += take;
+			data += take;
+			size -= take;
+			if(buffer_size_ < 64){
+				return;
+			}
+			detail::hash256_blocks(buffer_, 1, message_digest_);
+			buffer_size_ = 0;
 		}
-
-		buffer_.push_back(0x80);
-		while((buffer_.size() % 64) != 56){
-			buffer_.push_back(0);
+		std::size_t nblocks = size / 64;
+		if(nblocks > 0){
+			detail::hash256_blocks(data, nblocks, message_digest_);
+			data += nblocks * 64;
+			size -= nblocks * 64;
 		}
+		std::copy(data, data + size, buffer_);
+		buffer_size_ = size;
 	}
 
 	word_t message_digest_[8];
-	std::vector<byte_t> buffer_;
+	byte_t buffer_[64];
+	std::size_t buffer_size_;
+	unsigned long long data_length_;
 };
 
 template<typename RaIter>
@@ -285,6 +493,31 @@ void calc_hash(RaIter first, RaIter last, byte_t* hash)
 	hasher.get_hash_bytes(hash, hash + k_digest_size);
 }
 
+// Midstate hashing: `midstate` is a hasher that has already absorbed a
+// fixed prefix. Copying it resumes from the saved compression state, so
+// only the blocks touched by [first, last) and the padding are compressed.
+template<typename RaIter>
+void calc_hash_from_midstate(const hash256_one_by_one& midstate, RaIter first, RaIter last, byte_t* hash)
+{
+	hash256_one_by_one hasher(midstate);
+	hasher.process(first, last);
+	hasher.finish();
+	hasher.get_hash_bytes(hash, hash + k_digest_size);
+}
+
+template<typename RaIter>
+std::string hash256_hex_string_from_midstate(const hash256_one_by_one& midstate, RaIter first, RaIter last)
+{
+	byte_t hash[k_digest_size];
+	calc_hash_from_midstate(midstate, first, last, hash);
+	return bytes_to_hex_string(hash, hash + k_digest_size);
+}
+
+inline std::string hash256_hex_string_from_midstate(const hash256_one_by_one& midstate, const std::string& tail)
+{
+	return hash256_hex_string_from_midstate(midstate, tail.begin(), tail.end());
+}
+
 template<typename RaIter>
 void hash256_hex_string(RaIter first, RaIter last, std::string& hex_str)
 {
@@ -330,6 +563,949 @@ void hash256_bytes(const InContainer& src, std::vector<byte_t>& hash)
 	hash256_bytes(src.begin(), src.end(), hash);
 }
 
+// ---------------------------------------------------------------------------
+// Double SHA-256 (sha256d), as used for Bitcoin block headers.
+// The second round always hashes exactly 32 bytes: its single block is
+// pre-padded and compressed directly, without the streaming hasher.
+// ---------------------------------------------------------------------------
+
+namespace detail
+{
+
+inline void hash256_of_digest(const byte_t* digest, byte_t* hash)
+{
+	byte_t block[64] = { 0 };
+	std::copy(digest, digest + k_digest_size, block);
+	block[32] = 0x80;
+	block[62] = 0x01; // message length: 256 bits
+
+	word_t state[8];
+	std::copy(initial_message_digest, initial_message_digest + 8, state);
+	hash256_blocks(block, 1, state);
+	for (std::size_t i = 0; i < 8; ++i) {
+		store_be32(static_cast<std::uint32_t>(state[i]), hash + 4 * i);
+	}
+}
+
+} // namespace detail
+
+// Second round only: hash = SHA-256(digest) for a 32-byte digest.
+inline void hash256_of_digest(const byte_t* digest, byte_t* hash)
+{
+	detail::hash256_of_digest(digest, hash);
+}
+
+template<typename RaIter>
+void calc_hash256d(RaIter first, RaIter last, byte_t* hash)
+{
+	byte_t first_round[k_digest_size];
+	calc_hash(first, last, first_round);
+	detail::hash256_of_digest(first_round, hash);
+}
+
+template<typename RaIter>
+void calc_hash256d_from_midstate(const hash256_one_by_one& midstate, RaIter first, RaIter last, byte_t* hash)
+{
+	byte_t first_round[k_digest_size];
+	calc_hash_from_midstate(midstate, first, last, first_round);
+	detail::hash256_of_digest(first_round, hash);
+}
+
+template<typename RaIter>
+std::string hash256d_hex_string(RaIter first, RaIter last)
+{
+	byte_t hash[k_digest_size];
+	calc_hash256d(first, last, hash);
+	return bytes_to_hex_string(hash, hash + k_digest_size);
+}
+
+inline std::string hash256d_hex_string(const std::string& src)
+{
+	return hash256d_hex_string(src.begin(), src.end());
+}
+
+template<typename InContainer>
+void hash256d_bytes(const InContainer& src, std::vector<byte_t>& hash)
+{
+	hash.resize(k_digest_size);
+	calc_hash256d(src.begin(), src.end(), &hash[0]);
+}
+
+// ---------------------------------------------------------------------------
+// Multi-buffer hashing: independent messages are interleaved across the
+// 32-bit lanes of an AVX2 (8 lanes) or AVX-512 (16 lanes) register and
+// compressed together. The kernel is picked at runtime (see
+// hash256_batch_default_lanes); with lane width 1 every message goes
+// through calc_hash, and so through SHA-NI when available.
+// ---------------------------------------------------------------------------
+
+static const std::size_t k_batch_max_lanes = 16;
+
+namespace detail
+{
+
+// One message of a batch, seen as a sequence of 64-byte blocks. Full blocks
+// are read in place; the last one or two blocks are padded in `tail`.
+struct batch_lane
+{
+	const byte_t* data;
+	std::size_t full_blocks;
+	std::size_t total_blocks;
+	byte_t tail[128];
+
+	void init(const byte_t* d, std::size_t len)
+	{
+		data = d;
+		full_blocks = len / 64;
+		std::size_t rem = len % 64;
+		std::size_t tail_size = rem + 9 <= 64 ? 64 : 128;
+		std::fill(tail, tail + tail_size, 0);
+		std::copy(d + full_blocks * 64, d + len, tail);
+		tail[rem] = 0x80;
+		unsigned long long bits = static_cast<unsigned long long>(len) * 8;
+		for (std::size_t i = 0; i < 8; ++i) {
+			tail[tail_size - 1 - i] = static_cast<byte_t>(bits >> (8 * i));
+		}
+		total_blocks = full_blocks + tail_size / 64;
+	}
+
+	const byte_t* block(std::size_t b) const
+	{
+		return b < full_blocks ? data + 64 * b : tail + 64 * (b - full_blocks);
+	}
+};
+
+// state[word][lane]; lanes whose `active` entry is 0 keep their state.
+typedef void (*batch_kernel_t)(std::uint32_t state[8][k_batch_max_lanes],
+	const byte_t* const blocks[k_batch_max_lanes], const std::uint32_t active[k_batch_max_lanes]);
+
+#ifdef PICOSHA2_HAS_X86_SIMD
+#define PICOSHA2_AVX2 __attribute__((target("avx2")))
+
+PICOSHA2_AVX2 inline __m256i rotr_x8(__m256i x, int n)
+{
+	return _mm256_or_si256(_mm256_srli_epi32(x, n), _mm256_slli_epi32(x, 32 - n));
+}
+
+PICOSHA2_AVX2 inline void hash256_block_x8(std::uint32_t state[8][k_batch_max_lanes],
+	const byte_t* const blocks[k_batch_max_lanes], const std::uint32_t active[k_batch_max_lanes])
+{
+	__m256i w[64];
+	for (std::size_t i = 0; i < 16; ++i) {
+		std::uint32_t lanes[8];
+		for (std::size_t j = 0; j < 8; ++j) {
+			lanes[j] = load_be32(blocks[j] + 4 * i);
+		}
+		w[i] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lanes));
+	}
+	for (std::size_t i = 16; i < 64; ++i) {
+		__m256i s0 = _mm256_xor_si256(_mm256_xor_si256(rotr_x8(w[i - 15], 7), rotr_x8(w[i - 15], 18)), _mm256_srli_epi32(w[i - 15], 3));
+		__m256i s1 = _mm256_xor_si256(_mm256_xor_si256(rotr_x8(w[i - 2], 17), rotr_x8(w[i - 2], 19)), _mm256_srli_epi32(w[i - 2], 10));
+		w[i] = _mm256_add_epi32(_mm256_add_epi32(s1, w[i - 7]), _mm256_add_epi32(s0, w[i - 16]));
+	}
+
+	__m256i v[8];
+	for (std::size_t k = 0; k < 8; ++k) {
+		v[k] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(state[k]));
+	}
+	__m256i a = v[0], b = v[1], c = v[2], d = v[3], e = v[4], f = v[5], g = v[6], h = v[7];
+	for (std::size_t i = 0; i < 64; ++i) {
+		__m256i bs1 = _mm256_xor_si256(_mm256_xor_si256(rotr_x8(e, 6), rotr_x8(e, 11)), rotr_x8(e, 25));
+		__m256i chv = _mm256_xor_si256(_mm256_and_si256(e, f), _mm256_andnot_si256(e, g));
+		__m256i temp1 = _mm256_add_epi32(_mm256_add_epi32(h, bs1), _mm256_add_epi32(chv,
+			_mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(add_constant[i])), w[i])));
+		__m256i bs0 = _mm256_xor_si256(_mm256_xor_si256(rotr_x8(a, 2), rotr_x8(a, 13)), rotr_x8(a, 22));
+		__m256i majv = _mm256_xor_si256(_mm256_xor_si256(_mm256_and_si256(a, b), _mm256_and_si256(a, c)), _mm256_and_si256(b, c));
+		__m256i temp2 = _mm256_add_epi32(bs0, majv);
+		h = g;
+		g = f;
+		f = e;
+		e = _mm256_add_epi32(d, temp1);
+		d = c;
+		c = b;
+		b = a;
+		a = _mm256_add_epi32(temp1, temp2);
+	}
+
+	// inactive lanes add zero and keep their previous state
+	__m256i mask = _mm256_sub_epi32(_mm256_setzero_si256(),
+		_mm256_loadu_si256(reinterpret_cast<const __m256i*>(active)));
+	__m256i r[8] = { a, b, c, d, e, f, g, h };
+	for (std::size_t k = 0; k < 8; ++k) {
+		v[k] = _mm256_add_epi32(v[k], _mm256_and_si256(r[k], mask));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(state[k]), v[k]);
+	}
+}
+
+#define PICOSHA2_AVX512 __attribute__((target("avx512f")))
+
+// GCC flags the _mm512_undefined_epi32() placeholders inside the intrinsics
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+PICOSHA2_AVX512 inline void hash256_block_x16(std::uint32_t state[8][k_batch_max_lanes],
+	const byte_t* const blocks[k_batch_max_lanes], const std::uint32_t active[k_batch_max_lanes])
+{
+	__m512i w[64];
+	for (std::size_t i = 0; i < 16; ++i) {
+		std::uint32_t lanes[16];
+		for (std::size_t j = 0; j < 16; ++j) {
+			lanes[j] = load_be32(blocks[j] + 4 * i);
+		}
+		w[i] = _mm512_loadu_si512(lanes);
+	}
+	for (std::size_t i = 16; i < 64; ++i) {
+		__m512i s0 = _mm512_xor_si512(_mm512_xor_si512(_mm512_ror_epi32(w[i - 15], 7), _mm512_ror_epi32(w[i - 15], 18)), _mm512_srli_epi32(w[i - 15], 3));
+		__m512i s1 = _mm512_xor_si512(_mm512_xor_si512(_mm512_ror_epi32(w[i - 2], 17), _mm512_ror_epi32(w[i - 2], 19)), _mm512_srli_epi32(w[i - 2], 10));
+		w[i] = _mm512_add_epi32(_mm512_add_epi32(s1, w[i - 7]), _mm512_add_epi32(s0, w[i - 16]));
+	}
+
+	__m512i v[8];
+	for (std::size_t k = 0; k < 8; ++k) {
+		v[k] = _mm512_loadu_si512(state[k]);
+	}
+	__m512i a = v[0], b = v[1], c = v[2], d = v[3], e = v[4], f = v[5], g = v[6], h = v[7];
+	for (std::size_t i = 0; i < 64; ++i) {
+		__m512i bs1 = _mm512_xor_si512(_mm512_xor_si512(_mm512_ror_epi32(e, 6), _mm512_ror_epi32(e, 11)), _mm512_ror_epi32(e, 25));
+		__m512i chv = _mm512_xor_si512(_mm512_and_si512(e, f), _mm512_andnot_si512(e, g));
+		__m512i temp1 = _mm512_add_epi32(_mm512_add_epi32(h, bs1), _mm512_add_epi32(chv,
+			_mm512_add_epi32(_mm512_set1_epi32(static_cast<int>(add_constant[i])), w[i])));
+		__m512i bs0 = _mm512_xor_si512(_mm512_xor_si512(_mm512_ror_epi32(a, 2), _mm512_ror_epi32(a, 13)), _mm512_ror_epi32(a, 22));
+		__m512i majv = _mm512_or_si512(_mm512_and_si512(a, b), _mm512_and_si512(c, _mm512_or_si512(a, b)));
+		__m512i temp2 = _mm512_add_epi32(bs0, majv);
+		h = g;
+		g = f;
+		f = e;
+		e = _mm512_add_epi32(d, temp1);
+		d = c;
+		c = b;
+		b = a;
+		a = _mm512_add_epi32(temp1, temp2);
+	}
+
+	__mmask16 mask = 0;
+	for (std::size_t j = 0; j < 16; ++j) {
+		mask = static_cast<__mmask16>(mask | (active[j] ? 1u << j : 0u));
+	}
+	__m512i r[8] = { a, b, c, d, e, f, g, h };
+	for (std::size_t k = 0; k < 8; ++k) {
+		v[k] = _mm512_mask_add_epi32(v[k], mask, v[k], r[k]);
+		_mm512_storeu_si512(state[k], v[k]);
+	}
+}
+#pragma GCC diagnostic pop
+
+inline bool cpu_has_avx2()
+{
+	static const bool supported = __builtin_cpu_supports("avx2") != 0;
+	return supported;
+}
+
+inline bool cpu_has_avx512f()
+{
+	static const bool supported = __builtin_cpu_supports("avx512f") != 0;
+	return supported;
+}
+#else
+inline bool cpu_has_avx2() { return false; }
+inline bool cpu_has_avx512f() { return false; }
+#endif
+
+inline batch_kernel_t batch_kernel(std::size_t lanes)
+{
+#ifdef PICOSHA2_HAS_X86_SIMD
+	if (lanes == 16) {
+		return hash256_block_x16;
+	}
+	if (lanes == 8) {
+		return hash256_block_x8;
+	}
+#else
+	(void)lanes;
+#endif
+	return 0;
+}
+
+// Hashes messages[0..count) with `lanes` messages per kernel call.
+inline void hash256_batch_lanes(const byte_t* const* messages, const std::size_t* lengths,
+	std::size_t count, byte_t* hashes, std::size_t lanes)
+{
+	batch_kernel_t kernel = batch_kernel(lanes);
+	if (kernel == 0) {
+		for (std::size_t i = 0; i < count; ++i) {
+			calc_hash(messages[i], messages[i] + lengths[i], hashes + i * k_digest_size);
+		}
+		return;
+	}
+
+	static const byte_t zero_block[64] = { 0 };
+	batch_lane lane[k_batch_max_lanes];
+	for (std::size_t first = 0; first < count; first += lanes) {
+		std::size_t n = std::min(lanes, count - first);
+		std::size_t max_blocks = 0;
+		std::uint32_t state[8][k_batch_max_lanes];
+		for (std::size_t j = 0; j < n; ++j) {
+			lane[j].init(messages[first + j], lengths[first + j]);
+			max_blocks = std::max(max_blocks, lane[j].total_blocks);
+		}
+		for (std::size_t k = 0; k < 8; ++k) {
+			std::fill(state[k], state[k] + k_batch_max_lanes, static_cast<std::uint32_t>(initial_message_digest[k]));
+		}
+
+		for (std::size_t b = 0; b < max_blocks; ++b) {
+			const byte_t* blocks[k_batch_max_lanes];
+			std::uint32_t active[k_batch_max_lanes];
+			for (std::size_t j = 0; j < lanes; ++j) {
+				active[j] = j < n && b < lane[j].total_blocks;
+				blocks[j] = active[j] ? lane[j].block(b) : zero_block;
+			}
+			kernel(state, blocks, active);
+		}
+
+		for (std::size_t j = 0; j < n; ++j) {
+			byte_t* out = hashes + (first + j) * k_digest_size;
+			for (std::size_t k = 0; k < 8; ++k) {
+				store_be32(state[k][j], out + 4 * k);
+			}
+		}
+	}
+}
+
+} // namespace detail
+
+// True when single-stream hashing goes through the SHA extensions.
+inline bool sha_ni_enabled()
+{
+	return detail::sha_ni_allowed() && detail::cpu_has_sha_ni();
+}
+
+// Enables or disables the SHA-NI path; call before hashing starts.
+inline void use_sha_ni(bool enabled)
+{
+	detail::sha_ni_allowed() = enabled;
+}
+
+// Lane widths usable on this CPU: 16 (AVX-512), 8 (AVX2), 1 (scalar).
+inline bool hash256_batch_supported(std::size_t lanes)
+{
+	return lanes == 1 || (lanes == 8 && detail::cpu_has_avx2()) || (lanes == 16 && detail::cpu_has_avx512f());
+}
+
+inline std::size_t hash256_batch_lane_width()
+{
+	return hash256_batch_supported(16) ? 16 : hash256_batch_supported(8) ? 8 : 1;
+}
+
+// Lane width hash256_batch picks by default. A single SHA-NI stream is
+// faster than the AVX2 x8 kernel at every message size, so with the SHA
+// extensions only AVX-512 is worth batching for.
+inline std::size_t hash256_batch_default_lanes()
+{
+	std::size_t lanes = hash256_batch_lane_width();
+	return (lanes == 8 && sha_ni_enabled()) ? 1 : lanes;
+}
+
+// Hashes `count` independent messages; digest i is written to
+// hashes[32*i, 32*i+32). `lanes` = 0 selects hash256_batch_default_lanes().
+inline void hash256_batch(const byte_t* const* messages, const std::size_t* lengths,
+	std::size_t count, byte_t* hashes, std::size_t lanes = 0)
+{
+	if (lanes == 0 || !hash256_batch_supported(lanes)) {
+		lanes = hash256_batch_default_lanes();
+	}
+	detail::hash256_batch_lanes(messages, lengths, count, hashes, lanes);
+}
+
+inline void hash256_batch(const std::vector<std::string>& src, std::vector<byte_t>& hashes, std::size_t lanes = 0)
+{
+	std::vector<const byte_t*> messages(src.size());
+	std::vector<std::size_t> lengths(src.size());
+	for (std::size_t i = 0; i < src.size(); ++i) {
+		messages[i] = reinterpret_cast<const byte_t*>(src[i].data());
+		lengths[i] = src[i].size();
+	}
+	hashes.resize(src.size() * k_digest_size);
+	if (!src.empty()) {
+		hash256_batch(&messages[0], &lengths[0], src.size(), &hashes[0], lanes);
+	}
+}
+
+inline std::vector<std::string> hash256_hex_batch(const std::vector<std::string>& src, std::size_t lanes = 0)
+{
+	std::vector<byte_t> hashes;
+	hash256_batch(src, hashes, lanes);
+	std::vector<std::string> hex(src.size());
+	for (std::size_t i = 0; i < src.size(); ++i) {
+		bytes_to_hex_string(hashes.begin() + i * k_digest_size, hashes.begin() + (i + 1) * k_digest_size, hex[i]);
+	}
+	return hex;
+}
+
+// ---------------------------------------------------------------------------
+// Nonce sweep for proof of work. The header prefix has been compressed into
+// a midstate; the rest of the header fits with its padding in one final
+// block and holds a 64-bit little-endian nonce at a 4-byte aligned offset.
+// A pass evaluates 8 (AVX2) or 16 (AVX-512) consecutive nonces, one per
+// 32-bit lane. Everything that does not depend on the nonce is done once
+// per template: the schedule words that only read constant words and the
+// rounds before the first nonce word. A pass is rejected on the first
+// digest word when no lane can meet the target; full digests are only
+// extracted for the lanes that pass.
+// ---------------------------------------------------------------------------
+
+namespace detail
+{
+
+struct sweep_template
+{
+	std::uint32_t midstate[8];
+	std::uint32_t prefix_state[8];  // state after the constant rounds [0, nonce_word)
+	std::uint32_t w[64];            // message schedule; `varies` flags the nonce-dependent words
+	std::uint64_t varies;
+	std::size_t nonce_word;
+	bool double_hash;
+};
+
+inline std::uint32_t byte_swap32(std::uint32_t x)
+{
+	return x >> 24 | (x >> 8 & 0xff00) | (x << 8 & 0xff0000) | x << 24;
+}
+
+// Big-endian schedule words of a little-endian 64-bit nonce.
+inline void nonce_words(std::uint64_t nonce, std::uint32_t& low, std::uint32_t& high)
+{
+	low = byte_swap32(static_cast<std::uint32_t>(nonce));
+	high = byte_swap32(static_cast<std::uint32_t>(nonce >> 32));
+}
+
+inline void sweep_rounds(word_t v[8], const word_t* w, std::size_t first, std::size_t last)
+{
+	for (std::size_t i = first; i < last; ++i) {
+		word_t temp1 = v[7] + bsig1(v[4]) + ch(v[4], v[5], v[6]) + add_constant[i] + w[i];
+		word_t temp2 = bsig0(v[0]) + maj(v[0], v[1], v[2]);
+		for (std::size_t k = 7; k > 0; --k) {
+			v[k] = v[k - 1];
+		}
+		v[4] = mask_32bit(v[4] + temp1);
+		v[0] = mask_32bit(temp1 + temp2);
+	}
+}
+
+// `block` is the final, already padded block of the header.
+inline void init_sweep_template(sweep_template& t, const std::uint32_t midstate[8], const byte_t* block,
+	std::size_t nonce_offset, bool double_hash)
+{
+	t.nonce_word = nonce_offset / 4;
+	t.double_hash = double_hash;
+	t.varies = 3ULL << t.nonce_word;
+
+	word_t w[64];
+	for (std::size_t i = 0; i < 16; ++i) {
+		w[i] = load_be32(block + 4 * i);
+	}
+	for (std::size_t i = 16; i < 64; ++i) {
+		if ((t.varies >> (i - 2) | t.varies >> (i - 7) | t.varies >> (i - 15) | t.varies >> (i - 16)) & 1) {
+			t.varies |= 1ULL << i;
+			w[i] = 0;
+		} else {
+			w[i] = mask_32bit(ssig1(w[i - 2]) + w[i - 7] + ssig0(w[i - 15]) + w[i - 16]);
+		}
+	}
+
+	word_t v[8];
+	for (std::size_t k = 0; k < 8; ++k) {
+		t.midstate[k] = midstate[k];
+		v[k] = midstate[k];
+	}
+	sweep_rounds(v, w, 0, t.nonce_word);
+	for (std::size_t k = 0; k < 8; ++k) {
+		t.prefix_state[k] = static_cast<std::uint32_t>(v[k]);
+	}
+	for (std::size_t i = 0; i < 64; ++i) {
+		t.w[i] = static_cast<std::uint32_t>(w[i]);
+	}
+}
+
+// Portable evaluation of one nonce; digest words, most significant first.
+inline void sweep_digest(const sweep_template& t, std::uint64_t nonce, std::uint32_t digest[8])
+{
+	word_t w[64];
+	std::copy(t.w, t.w + 64, w);
+	std::uint32_t low, high;
+	nonce_words(nonce, low, high);
+	w[t.nonce_word] = low;
+	w[t.nonce_word + 1] = high;
+	for (std::size_t i = 16; i < 64; ++i) {
+		if (t.varies >> i & 1) {
+			w[i] = mask_32bit(ssig1(w[i - 2]) + w[i - 7] + ssig0(w[i - 15]) + w[i - 16]);
+		}
+	}
+
+	word_t v[8];
+	std::copy(t.prefix_state, t.prefix_state + 8, v);
+	sweep_rounds(v, w, t.nonce_word, 64);
+	for (std::size_t k = 0; k < 8; ++k) {
+		digest[k] = static_cast<std::uint32_t>(t.midstate[k] + v[k]);
+	}
+	if (t.double_hash) {
+		byte_t first[k_digest_size];
+		byte_t second[k_digest_size];
+		for (std::size_t k = 0; k < 8; ++k) {
+			store_be32(digest[k], first + 4 * k);
+		}
+		hash256_of_digest(first, second);
+		for (std::size_t k = 0; k < 8; ++k) {
+			digest[k] = load_be32(second + 4 * k);
+		}
+	}
+}
+
+// Digest and target compared as big-endian 256-bit integers.
+inline bool digest_meets_target(const std::uint32_t digest[8], const std::uint32_t* target)
+{
+	for (std::size_t k = 0; k < 8; ++k) {
+		if (digest[k] != target[k]) {
+			return digest[k] < target[k];
+		}
+	}
+	return true;
+}
+
+// Returns the bitmask of the lanes (nonces first + j) that meet the target.
+typedef std::uint32_t (*sweep_kernel_t)(const sweep_template& t, std::uint64_t first, const std::uint32_t* target);
+
+inline std::uint32_t sweep_x1(const sweep_template& t, std::uint64_t first, const std::uint32_t* target)
+{
+	std::uint32_t digest[8];
+	sweep_digest(t, first, digest);
+	return digest_meets_target(digest, target) ? 1 : 0;
+}
+
+#ifdef PICOSHA2_HAS_X86_SIMD
+PICOSHA2_AVX2 inline void sweep_rounds_x8(__m256i v[8], const __m256i* w, std::size_t first)
+{
+	__m256i a = v[0], b = v[1], c = v[2], d = v[3], e = v[4], f = v[5], g = v[6], h = v[7];
+	for (std::size_t i = first; i < 64; ++i) {
+		__m256i bs1 = _mm256_xor_si256(_mm256_xor_si256(rotr_x8(e, 6), rotr_x8(e, 11)), rotr_x8(e, 25));
+		__m256i chv = _mm256_xor_si256(_mm256_and_si256(e, f), _mm256_andnot_si256(e, g));
+		__m256i temp1 = _mm256_add_epi32(_mm256_add_epi32(h, bs1), _mm256_add_epi32(chv,
+			_mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(add_constant[i])), w[i])));
+		__m256i bs0 = _mm256_xor_si256(_mm256_xor_si256(rotr_x8(a, 2), rotr_x8(a, 13)), rotr_x8(a, 22));
+		__m256i majv = _mm256_xor_si256(_mm256_xor_si256(_mm256_and_si256(a, b), _mm256_and_si256(a, c)), _mm256_and_si256(b, c));
+		__m256i temp2 = _mm256_add_epi32(bs0, majv);
+		h = g;
+		g = f;
+		f = e;
+		e = _mm256_add_epi32(d, temp1);
+		d = c;
+		c = b;
+		b = a;
+		a = _mm256_add_epi32(temp1, temp2);
+	}
+	v[0] = a; v[1] = b; v[2] = c; v[3] = d; v[4] = e; v[5] = f; v[6] = g; v[7] = h;
+}
+
+PICOSHA2_AVX2 inline __m256i schedule_word_x8(const __m256i* w, std::size_t i)
+{
+	__m256i s0 = _mm256_xor_si256(_mm256_xor_si256(rotr_x8(w[i - 15], 7), rotr_x8(w[i - 15], 18)), _mm256_srli_epi32(w[i - 15], 3));
+	__m256i s1 = _mm256_xor_si256(_mm256_xor_si256(rotr_x8(w[i - 2], 17), rotr_x8(w[i - 2], 19)), _mm256_srli_epi32(w[i - 2], 10));
+	return _mm256_add_epi32(_mm256_add_epi32(s1, w[i - 7]), _mm256_add_epi32(s0, w[i - 16]));
+}
+
+PICOSHA2_AVX2 inline std::uint32_t sweep_x8(const sweep_template& t, std::uint64_t first, const std::uint32_t* target)
+{
+	std::uint32_t low[8], high[8];
+	for (std::size_t j = 0; j < 8; ++j) {
+		nonce_words(first + j, low[j], high[j]);
+	}
+	__m256i w[64];
+	for (std::size_t i = 0; i < 64; ++i) {
+		if (!(t.varies >> i & 1)) {
+			w[i] = _mm256_set1_epi32(static_cast<int>(t.w[i]));
+		} else if (i == t.nonce_word) {
+			w[i] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(low));
+		} else if (i == t.nonce_word + 1) {
+			w[i] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(high));
+		} else {
+			w[i] = schedule_word_x8(w, i);
+		}
+	}
+
+	__m256i v[8], base[8];
+	for (std::size_t k = 0; k < 8; ++k) {
+		v[k] = _mm256_set1_epi32(static_cast<int>(t.prefix_state[k]));
+		base[k] = _mm256_set1_epi32(static_cast<int>(t.midstate[k]));
+	}
+	sweep_rounds_x8(v, w, t.nonce_word);
+
+	if (t.double_hash) {
+		// second block: the first digest, then the padding of a 256-bit message
+		for (std::size_t k = 0; k < 8; ++k) {
+			w[k] = _mm256_add_epi32(v[k], base[k]);
+			w[k + 8] = _mm256_setzero_si256();
+			base[k] = _mm256_set1_epi32(static_cast<int>(initial_message_digest[k]));
+			v[k] = base[k];
+		}
+		w[8] = _mm256_set1_epi32(static_cast<int>(0x80000000u));
+		w[15] = _mm256_set1_epi32(256);
+		for (std::size_t i = 16; i < 64; ++i) {
+			w[i] = schedule_word_x8(w, i);
+		}
+		sweep_rounds_x8(v, w, 0);
+	}
+
+	// early reject: first digest word <= target[0] (unsigned) in no lane
+	__m256i h0 = _mm256_add_epi32(v[0], base[0]);
+	__m256i t0 = _mm256_set1_epi32(static_cast<int>(target[0]));
+	std::uint32_t candidates = static_cast<std::uint32_t>(_mm256_movemask_ps(
+		_mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_max_epu32(h0, t0), t0))));
+	if (candidates == 0) {
+		return 0;
+	}
+
+	std::uint32_t words[8][8];
+	for (std::size_t k = 0; k < 8; ++k) {
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(words[k]), _mm256_add_epi32(v[k], base[k]));
+	}
+	std::uint32_t found = 0;
+	for (std::size_t j = 0; j < 8; ++j) {
+		std::uint32_t digest[8];
+		for (std::size_t k = 0; k < 8; ++k) {
+			digest[k] = words[k][j];
+		}
+		if ((candidates >> j & 1) && digest_meets_target(digest, target)) {
+			found |= 1u << j;
+		}
+	}
+	return found;
+}
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+PICOSHA2_AVX512 inline void sweep_rounds_x16(__m512i v[8], const __m512i* w, std::size_t first)
+{
+	__m512i a = v[0], b = v[1], c = v[2], d = v[3], e = v[4], f = v[5], g = v[6], h = v[7];
+	for (std::size_t i = first; i < 64; ++i) {
+		__m512i bs1 = _mm512_xor_si512(_mm512_xor_si512(_mm512_ror_epi32(e, 6), _mm512_ror_epi32(e, 11)), _mm512_ror_epi32(e, 25));
+		__m512i chv = _mm512_xor_si512(_mm512_and_si512(e, f), _mm512_andnot_si512(e, g));
+		__m512i temp1 = _mm512_add_epi32(_mm512_add_epi32(h, bs1), _mm512_add_epi32(chv,
+			_mm512_add_epi32(_mm512_set1_epi32(static_cast<int>(add_constant[i])), w[i])));
+		__m512i bs0 = _mm512_xor_si512(_mm512_xor_si512(_mm512_ror_epi32(a, 2), _mm512_ror_epi32(a, 13)), _mm512_ror_epi32(a, 22));
+		__m512i majv = _mm512_or_si512(_mm512_and_si512(a, b), _mm512_and_si512(c, _mm512_or_si512(a, b)));
+		__m512i temp2 = _mm512_add_epi32(bs0, majv);
+		h = g;
+		g = f;
+		f = e;
+		e = _mm512_add_epi32(d, temp1);
+		d = c;
+		c = b;
+		b = a;
+		a = _mm512_add_epi32(temp1, temp2);
+	}
+	v[0] = a; v[1] = b; v[2] = c; v[3] = d; v[4] = e; v[5] = f; v[6] = g; v[7] = h;
+}
+
+PICOSHA2_AVX512 inline __m512i schedule_word_x16(const __m512i* w, std::size_t i)
+{
+	__m512i s0 = _mm512_xor_si512(_mm512_xor_si512(_mm512_ror_epi32(w[i - 15], 7), _mm512_ror_epi32(w[i - 15], 18)), _mm512_srli_epi32(w[i - 15], 3));
+	__m512i s1 = _mm512_xor_si512(_mm512_xor_si512(_mm512_ror_epi32(w[i - 2], 17), _mm512_ror_epi32(w[i - 2], 19)), _mm512_srli_epi32(w[i - 2], 10));
+	return _mm512_add_epi32(_mm512_add_epi32(s1, w[i - 7]), _mm512_add_epi32(s0, w[i - 16]));
+}
+
+PICOSHA2_AVX512 inline std::uint32_t sweep_x16(const sweep_template& t, std::uint64_t first, const std::uint32_t* target)
+{
+	std::uint32_t low[16], high[16];
+	for (std::size_t j = 0; j < 16; ++j) {
+		nonce_words(first + j, low[j], high[j]);
+	}
+	__m512i w[64];
+	for (std::size_t i = 0; i < 64; ++i) {
+		if (!(t.varies >> i & 1)) {
+			w[i] = _mm512_set1_epi32(static_cast<int>(t.w[i]));
+		} else if (i == t.nonce_word) {
+			w[i] = _mm512_loadu_si512(low);
+		} else if (i == t.nonce_word + 1) {
+			w[i] = _mm512_loadu_si512(high);
+		} else {
+			w[i] = schedule_word_x16(w, i);
+		}
+	}
+
+	__m512i v[8], base[8];
+	for (std::size_t k = 0; k < 8; ++k) {
+		v[k] = _mm512_set1_epi32(static_cast<int>(t.prefix_state[k]));
+		base[k] = _mm512_set1_epi32(static_cast<int>(t.midstate[k]));
+	}
+	sweep_rounds_x16(v, w, t.nonce_word);
+
+	if (t.double_hash) {
+		for (std::size_t k = 0; k < 8; ++k) {
+			w[k] = _mm512_add_epi32(v[k], base[k]);
+			w[k + 8] = _mm512_setzero_si512();
+			base[k] = _mm512_set1_epi32(static_cast<int>(initial_message_digest[k]));
+			v[k] = base[k];
+		}
+		w[8] = _mm512_set1_epi32(static_cast<int>(0x80000000u));
+		w[15] = _mm512_set1_epi32(256);
+		for (std::size_t i = 16; i < 64; ++i) {
+			w[i] = schedule_word_x16(w, i);
+		}
+		sweep_rounds_x16(v, w, 0);
+	}
+
+	std::uint32_t candidates = _mm512_cmple_epu32_mask(_mm512_add_epi32(v[0], base[0]),
+		_mm512_set1_epi32(static_cast<int>(target[0])));
+	if (candidates == 0) {
+		return 0;
+	}
+
+	std::uint32_t words[8][16];
+	for (std::size_t k = 0; k < 8; ++k) {
+		_mm512_storeu_si512(words[k], _mm512_add_epi32(v[k], base[k]));
+	}
+	std::uint32_t found = 0;
+	for (std::size_t j = 0; j < 16; ++j) {
+		std::uint32_t digest[8];
+		for (std::size_t k = 0; k < 8; ++k) {
+			digest[k] = words[k][j];
+		}
+		if ((candidates >> j & 1) && digest_meets_target(digest, target)) {
+			found |= 1u << j;
+		}
+	}
+	return found;
+}
+#pragma GCC diagnostic pop
+#endif
+
+inline sweep_kernel_t sweep_kernel(std::size_t lanes)
+{
+#ifdef PICOSHA2_HAS_X86_SIMD
+	if (lanes == 16) {
+		return sweep_x16;
+	}
+	if (lanes == 8) {
+		return sweep_x8;
+	}
+#endif
+	return sweep_x1;
+}
+
+} // namespace detail
+
+class nonce_sweep
+{
+public:
+	// `midstate` has absorbed the header prefix, a whole number of blocks;
+	// tail[0, tail_size) is the rest of the header (at most 55 bytes) with
+	// the nonce at tail[nonce_offset, nonce_offset + 8), nonce_offset a
+	// multiple of 4. `lanes` = 0 selects the widest supported kernel.
+	nonce_sweep(const hash256_one_by_one& midstate, const byte_t* tail, std::size_t tail_size,
+		std::size_t nonce_offset, bool double_hash, std::size_t lanes = 0)
+	{
+		byte_t block[64] = { 0 };
+		std::copy(tail, tail + tail_size, block);
+		block[tail_size] = 0x80;
+		unsigned long long bits = (midstate.length() + tail_size) * 8;
+		for (std::size_t i = 0; i < 8; ++i) {
+			block[63 - i] = static_cast<byte_t>(bits >> (8 * i));
+		}
+		std::uint32_t state[8];
+		midstate.get_state(state);
+		detail::init_sweep_template(template_, state, block, nonce_offset, double_hash);
+
+		if (lanes == 0 || !hash256_batch_supported(lanes)) {
+			lanes = hash256_batch_lane_width();
+		}
+		lanes_ = lanes;
+		kernel_ = detail::sweep_kernel(lanes);
+	}
+
+	// Nonces evaluated per pass: 16, 8 or 1.
+	std::size_t lanes()const
+	{
+		return lanes_;
+	}
+
+	// Evaluates nonces [first, first + lanes()) and returns the bitmask of
+	// the lanes whose digest, read as a big-endian 256-bit integer, is at
+	// most `target` (8 words, most significant first).
+	std::uint32_t sweep(std::uint64_t first, const std::uint32_t* target)const
+	{
+		return kernel_(template_, first, target);
+	}
+
+	// Digest of a single nonce through the portable path.
+	void hash(std::uint64_t nonce, byte_t* out)const
+	{
+		std::uint32_t digest[8];
+		detail::sweep_digest(template_, nonce, digest);
+		for (std::size_t k = 0; k < 8; ++k) {
+			detail::store_be32(digest[k], out + 4 * k);
+		}
+	}
+
+private:
+	detail::sweep_template template_;
+	std::size_t lanes_;
+	detail::sweep_kernel_t kernel_;
+};
+
+
+#if __cplusplus >= 201402L
+// ---------------------------------------------------------------------------
+// Compile-time SHA-256 (C++14 relaxed constexpr). Meant for constants such
+// as genesis block hashes and known test vectors, and as a slow reference
+// for the runtime kernels.
+// ---------------------------------------------------------------------------
+
+struct constexpr_digest
+{
+	byte_t bytes[k_digest_size];
+
+	constexpr bool operator==(const constexpr_digest& other) const
+	{
+		for (std::size_t i = 0; i < k_digest_size; ++i) {
+			if (bytes[i] != other.bytes[i]) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	constexpr bool operator!=(const constexpr_digest& other) const
+	{
+		return !(*this == other);
+	}
+};
+
+namespace detail
+{
+
+constexpr std::uint32_t constexpr_rotr(std::uint32_t x, std::size_t n)
+{
+	return (x >> n) | (x << (32 - n));
+}
+
+// Byte i of the message padded to padded_len bytes.
+template<typename Byte>
+constexpr byte_t constexpr_padded_byte(const Byte* data, std::size_t len, std::size_t padded_len, std::size_t i)
+{
+	if (i < len) {
+		return static_cast<byte_t>(data[i]);
+	}
+	if (i == len) {
+		return 0x80;
+	}
+	if (i >= padded_len - 8) {
+		return static_cast<byte_t>(static_cast<unsigned long long>(len) * 8 >> (8 * (padded_len - 1 - i)));
+	}
+	return 0;
+}
+
+template<typename Byte>
+constexpr constexpr_digest constexpr_hash256(const Byte* data, std::size_t len)
+{
+	std::uint32_t state[8] = {};
+	for (std::size_t k = 0; k < 8; ++k) {
+		state[k] = static_cast<std::uint32_t>(initial_message_digest[k]);
+	}
+
+	std::size_t padded_len = (len + 9 + 63) / 64 * 64;
+	for (std::size_t offset = 0; offset < padded_len; offset += 64) {
+		std::uint32_t w[64] = {};
+		for (std::size_t i = 0; i < 16; ++i) {
+			for (std::size_t j = 0; j < 4; ++j) {
+				w[i] = w[i] << 8 | constexpr_padded_byte(data, len, padded_len, offset + 4 * i + j);
+			}
+		}
+		for (std::size_t i = 16; i < 64; ++i) {
+			std::uint32_t s0 = constexpr_rotr(w[i - 15], 7) ^ constexpr_rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+			std::uint32_t s1 = constexpr_rotr(w[i - 2], 17) ^ constexpr_rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+			w[i] = s1 + w[i - 7] + s0 + w[i - 16];
+		}
+
+		std::uint32_t v[8] = {};
+		for (std::size_t k = 0; k < 8; ++k) {
+			v[k] = state[k];
+		}
+		for (std::size_t i = 0; i < 64; ++i) {
+			std::uint32_t bs1 = constexpr_rotr(v[4], 6) ^ constexpr_rotr(v[4], 11) ^ constexpr_rotr(v[4], 25);
+			std::uint32_t chv = (v[4] & v[5]) ^ (~v[4] & v[6]);
+			std::uint32_t temp1 = v[7] + bs1 + chv + static_cast<std::uint32_t>(add_constant[i]) + w[i];
+			std::uint32_t bs0 = constexpr_rotr(v[0], 2) ^ constexpr_rotr(v[0], 13) ^ constexpr_rotr(v[0], 22);
+			std::uint32_t majv = (v[0] & v[1]) ^ (v[0] & v[2]) ^ (v[1] & v[2]);
+			for (std::size_t k = 7; k > 0; --k) {
+				v[k] = v[k - 1];
+			}
+			v[4] += temp1;
+			v[0] = temp1 + bs0 + majv;
+		}
+		for (std::size_t k = 0; k < 8; ++k) {
+			state[k] += v[k];
+		}
+	}
+
+	constexpr_digest digest = {};
+	for (std::size_t k = 0; k < 8; ++k) {
+		for (std::size_t j = 0; j < 4; ++j) {
+			digest.bytes[4 * k + j] = static_cast<byte_t>(state[k] >> (24 - 8 * j));
+		}
+	}
+	return digest;
+}
+
+constexpr byte_t constexpr_hex_value(char c)
+{
+	return static_cast<byte_t>(c <= '9' ? c - '0' : c <= 'F' ? c - 'A' + 10 : c - 'a' + 10);
+}
+
+} // namespace detail
+
+constexpr constexpr_digest constexpr_hash256(const char* data, std::size_t len)
+{
+	return detail::constexpr_hash256(data, len);
+}
+
+constexpr constexpr_digest constexpr_hash256(const byte_t* data, std::size_t len)
+{
+	return detail::constexpr_hash256(data, len);
+}
+
+// String literal overload: the terminating '\0' is not hashed.
+template<std::size_t N>
+constexpr constexpr_digest constexpr_hash256(const char (&str)[N])
+{
+	return detail::constexpr_hash256(str, N - 1);
+}
+
+constexpr constexpr_digest constexpr_hash256d(const char* data, std::size_t len)
+{
+	constexpr_digest first = detail::constexpr_hash256(data, len);
+	return detail::constexpr_hash256(first.bytes, k_digest_size);
+}
+
+// Parses a 64-character hex digest, e.g. a published test vector.
+constexpr constexpr_digest constexpr_digest_from_hex(const char* hex)
+{
+	constexpr_digest digest = {};
+	for (std::size_t i = 0; i < k_digest_size; ++i) {
+		digest.bytes[i] = static_cast<byte_t>(detail::constexpr_hex_value(hex[2 * i]) << 4 | detail::constexpr_hex_value(hex[2 * i + 1]));
+	}
+	return digest;
+}
+
+static_assert(constexpr_hash256("") == constexpr_digest_from_hex(
+	"e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855"), "SHA-256 test vector (empty)");
+static_assert(constexpr_hash256("abc") == constexpr_digest_from_hex(
+	"ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"), "SHA-256 test vector (abc)");
+static_assert(constexpr_hash256("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq") == constexpr_digest_from_hex(
+	"248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1"), "SHA-256 test vector (two blocks)");
+#endif // __cplusplus >= 201402L
+
 } // namespace picosha2
 
 #endif //PICOSHA2_H
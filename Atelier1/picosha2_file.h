@@ -0,0 +1,114 @@
+#ifndef PICOSHA2_FILE_H
+#define PICOSHA2_FILE_H
+// File hashing on top of picosha2::hash256_one_by_one.
+// POSIX: the file is memory-mapped and its pages are fed to the
+// compression function in place. Elsewhere (or if mmap fails) it is read
+// in 1 MiB chunks, a multiple of the 64-byte block size.
+#include <string>
+#include <vector>
+#include <cstdio>
+#include "picosha2.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define PICOSHA2_HAS_MMAP 1
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace picosha2
+{
+
+static const std::size_t k_file_chunk_size = 1 << 20;
+
+namespace detail
+{
+
+inline bool hash_file_chunked(const std::string& path, hash256_one_by_one& hasher)
+{
+	std::FILE* file = std::fopen(path.c_str(), "rb");
+	if (!file) {
+		return false;
+	}
+	std::vector<byte_t> chunk(k_file_chunk_size);
+	std::size_t n;
+	while ((n = std::fread(&chunk[0], 1, chunk.size(), file)) > 0) {
+		hasher.process(&chunk[0], &chunk[0] + n);
+	}
+	bool ok = !std::ferror(file);
+	std::fclose(file);
+	return ok;
+}
+
+#ifdef PICOSHA2_HAS_MMAP
+// Returns false only if the file cannot be opened; mmap failures fall
+// back to chunked reads.
+inline bool hash_file_mmap(const std::string& path, hash256_one_by_one& hasher)
+{
+	int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0) {
+		return false;
+	}
+	struct stat st;
+	if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+		::close(fd);
+		return hash_file_chunked(path, hasher);
+	}
+	std::size_t size = static_cast<std::size_t>(st.st_size);
+	if (size == 0) {
+		::close(fd);
+		return true;
+	}
+	void* mapping = ::mmap(0, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);
+	if (mapping == MAP_FAILED) {
+		return hash_file_chunked(path, hasher);
+	}
+	::madvise(mapping, size, MADV_SEQUENTIAL);
+	const byte_t* data = static_cast<const byte_t*>(mapping);
+	hasher.process(data, data + size);
+	::munmap(mapping, size);
+	return true;
+}
+#endif
+
+} // namespace detail
+
+// Writes the SHA-256 of the file's contents to hash[0, 32).
+// Returns false if the file cannot be read.
+inline bool hash_file(const std::string& path, byte_t* hash)
+{
+	hash256_one_by_one hasher;
+#ifdef PICOSHA2_HAS_MMAP
+	bool ok = detail::hash_file_mmap(path, hasher);
+#else
+	bool ok = detail::hash_file_chunked(path, hasher);
+#endif
+	if (!ok) {
+		return false;
+	}
+	hasher.finish();
+	hasher.get_hash_bytes(hash, hash + k_digest_size);
+	return true;
+}
+
+inline bool hash_file(const std::string& path, std::vector<byte_t>& hash)
+{
+	hash.resize(k_digest_size);
+	return hash_file(path, &hash[0]);
+}
+
+// Hex digest of the file, or an empty string if it cannot be read.
+inline std::string hash_file_hex_string(const std::string& path)
+{
+	byte_t hash[k_digest_size];
+	if (!hash_file(path, hash)) {
+		return std::string();
+	}
+	return bytes_to_hex_string(hash, hash + k_digest_size);
+}
+
+} // namespace picosha2
+
+#endif //PICOSHA2_FILE_H
@@ -0,0 +1,191 @@
+#ifndef SPARSE_MERKLE_H
+#define SPARSE_MERKLE_H
+
+#include <vector>
+#include <string>
+#include <utility>
+#include <algorithm>
+#include <unordered_map>
+#include "hash256.h"
+
+// Arbre de Merkle creux à clés de 256 bits (engagement sur l'état des comptes).
+// La feuille d'une clé est au bout du chemin donné par ses bits, du poids
+// fort (racine) au poids faible (feuille). Une feuille absente vaut zéro et
+// un sous-arbre vide de hauteur h a un hash constant, précalculé : seuls
+// les noeuds non vides sont stockés, et une mise à jour ne rehache que les
+// chemins des clés touchées.
+
+// Preuve d'inclusion (ou d'absence, avec une feuille nulle). Les frères vides
+// ne sont pas transmis : le bit h de `nonEmpty` indique si le frère de
+// hauteur h figure dans `siblings` (ordre : de la feuille vers la racine).
+struct SparseMerkleProof {
+    picosha2::byte_t nonEmpty[32];
+    std::vector<Hash256> siblings;
+
+    bool hasSibling(size_t height) const {
+        return (nonEmpty[height / 8] >> (height % 8)) & 1;
+    }
+};
+
+class SparseMerkleTree {
+public:
+    static const size_t k_depth = 256;
+
+    // Hash d'un sous-arbre vide de hauteur h (0 = feuille absente)
+    static const Hash256& emptyHash(size_t height) {
+        static const std::vector<Hash256> table = []() {
+            std::vector<Hash256> hashes(k_depth + 1, Hash256::zero());
+            for(size_t h = 1; h <= k_depth; h++) {
+                hashes[h] = hashPair(hashes[h - 1], hashes[h - 1]);
+            }
+            return hashes;
+        }();
+        return table[height];
+    }
+
+    // Feuille d'un compte : la clé et la valeur sont toutes deux engagées
+    static Hash256 leafHash(const Hash256& key, const std::string& value) {
+        return hashPair(key, sha256Hash(value));
+    }
+
+    Hash256 root() const {
+        return node(0, Hash256::zero());
+    }
+
+    // Feuille stockée pour `key`, zéro si absente
+    Hash256 get(const Hash256& key) const {
+        return node(k_depth, key);
+    }
+
+    // Applique un lot de feuilles (zéro = suppression), puis rehache une seule
+    // fois chaque noeud des chemins touchés, niveau par niveau
+    void update(const std::vector<std::pair<Hash256, Hash256>>& leaves) {
+        std::vector<Hash256> touched;
+        for(const auto& leaf : leaves) {
+            setNode(k_depth, leaf.first, leaf.second);
+            touched.push_back(leaf.first);
+        }
+        std::sort(touched.begin(), touched.end());
+        touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+
+        for(size_t depth = k_depth; depth > 0; depth--) {
+            // Les préfixes triés restent triés : les doublons sont adjacents
+            std::vector<Hash256> parents;
+            for(const Hash256& prefix : touched) {
+                Hash256 parent = truncate(prefix, depth - 1);
+                if(parents.empty() || parents.back() != parent) {
+                    parents.push_back(parent);
+                }
+            }
+            for(const Hash256& parent : parents) {
+                Hash256 right = parent;
+                setBit(right, depth - 1);
+                setNode(depth - 1, parent, hashPair(node(depth, parent), node(depth, right)));
+            }
+            touched.swap(parents);
+        }
+    }
+
+    void update(const Hash256& key, const Hash256& leaf) {
+        update(std::vector<std::pair<Hash256, Hash256>>(1, std::make_pair(key, leaf)));
+    }
+
+    SparseMerkleProof prove(const Hash256& key) const {
+        SparseMerkleProof proof;
+        std::fill(proof.nonEmpty, proof.nonEmpty + sizeof(proof.nonEmpty), 0);
+        for(size_t height = 0; height < k_depth; height++) {
+            size_t depth = k_depth - height;
+            Hash256 sibling = truncate(key, depth);
+            flipBit(sibling, depth - 1);
+            Hash256 hash = node(depth, sibling);
+            if(hash != emptyHash(height)) {
+                proof.nonEmpty[height / 8] |= static_cast<picosha2::byte_t>(1 << (height % 8));
+                proof.siblings.push_back(hash);
+            }
+        }
+        return proof;
+    }
+
+    // Nombre de noeuds non vides stockés (feuilles comprises)
+    size_t storedNodes() const {
+        return nodes.size();
+    }
+
+    static bool bitAt(const Hash256& key, size_t i) {
+        return (key.bytes[i / 8] >> (7 - i % 8)) & 1;
+    }
+
+private:
+    // Un noeud est identifié par sa profondeur et les `depth` premiers bits
+    // de la clé (les suivants sont à zéro)
+    struct NodeId {
+        Hash256 prefix;
+        size_t depth;
+
+        bool operator==(const NodeId& other) const {
+            return depth == other.depth && prefix == other.prefix;
+        }
+    };
+
+    struct NodeIdHash {
+        size_t operator()(const NodeId& id) const {
+            return std::hash<Hash256>()(id.prefix) ^ (id.depth * 0x9e3779b97f4a7c15ULL);
+        }
+    };
+
+    std::unordered_map<NodeId, Hash256, NodeIdHash> nodes;
+
+    static Hash256 truncate(const Hash256& key, size_t depth) {
+        Hash256 prefix = key;
+        size_t keep = depth / 8;
+        if(depth % 8) {
+            prefix.bytes[keep] &= static_cast<picosha2::byte_t>(0xff << (8 - depth % 8));
+            keep++;
+        }
+        std::fill(prefix.bytes + keep, prefix.bytes + sizeof(prefix.bytes), 0);
+        return prefix;
+    }
+
+    static void setBit(Hash256& key, size_t i) {
+        key.bytes[i / 8] |= static_cast<picosha2::byte_t>(0x80 >> (i % 8));
+    }
+
+    static void flipBit(Hash256& key, size_t i) {
+        key.bytes[i / 8] ^= static_cast<picosha2::byte_t>(0x80 >> (i % 8));
+    }
+
+    Hash256 node(size_t depth, const Hash256& prefix) const {
+        auto it = nodes.find(NodeId{prefix, depth});
+        return (it == nodes.end()) ? emptyHash(k_depth - depth) : it->second;
+    }
+
+    void setNode(size_t depth, const Hash256& prefix, const Hash256& hash) {
+        if(hash == emptyHash(k_depth - depth)) {
+            nodes.erase(NodeId{prefix, depth});
+        } else {
+            nodes[NodeId{prefix, depth}] = hash;
+        }
+    }
+};
+
+// Vérifie qu'à `key` correspond la feuille `leaf` (zéro pour une preuve
+// d'absence) dans l'arbre de racine `root`
+inline bool verifySparseMerkleProof(const Hash256& root, const Hash256& key, const Hash256& leaf,
+                                    const SparseMerkleProof& proof) {
+    Hash256 current = leaf;
+    size_t used = 0;
+    for(size_t height = 0; height < SparseMerkleTree::k_depth; height++) {
+        Hash256 sibling = SparseMerkleTree::emptyHash(height);
+        if(proof.hasSibling(height)) {
+            if(used >= proof.siblings.size()) {
+                return false;
+            }
+            sibling = proof.siblings[used++];
+        }
+        bool right = SparseMerkleTree::bitAt(key, SparseMerkleTree::k_depth - 1 - height);
+        current = right ? hashPair(sibling, current) : hashPair(current, sibling);
+    }
+    return used == proof.siblings.size() && current == root;
+}
+
+#endif
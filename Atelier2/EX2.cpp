@@ -1,7 +1,6 @@
 #include "EX2.h"
 #include "EX1.h"
-#include <sstream>
-#include <iomanip>
+#include "../common/hex.h"
 #include <algorithm>
 
 std::vector<bool> string_to_bits(const std::string& input) {
@@ -15,7 +14,7 @@ std::vector<bool> string_to_bits(const std::string& input) {
 }
 
 std::string extract_hash(const std::vector<bool>& state) {
-    std::stringstream ss;
+    std::string hash(64, '0');
     
     for (size_t i = 0; i < 64; ++i) {
         int nibble = 0;
@@ -23,10 +22,10 @@ std::string extract_hash(const std::vector<bool>& state) {
             size_t bit_idx = ((i * 4 + j) * 13 + i * 7) % state.size();
             nibble = (nibble << 1) | state[bit_idx];
         }
-        ss << std::hex << nibble;
+        hash[i] = hex::k_digits[nibble];
     }
     
-    return ss.str();
+    return hash;
 }
 
 std::string ac_hash(const std::string& input, uint32_t rule, size_t steps) {
@@ -80,12 +79,13 @@ std::string sha256_simple(const std::string& input) {
     h3 ^= h3 >> 16;
     h4 ^= h4 >> 16;
     
-    // Formatage en hex (64 caractères = 256 bits)
-    std::stringstream ss;
-    ss << std::hex << std::setw(16) << std::setfill('0') << h1;
-    ss << std::hex << std::setw(16) << std::setfill('0') << h2;
-    ss << std::hex << std::setw(16) << std::setfill('0') << h3;
-    ss << std::hex << std::setw(16) << std::setfill('0') << h4;
-    
-    return ss.str();
+    // Formatage en hex (64 caractères = 256 bits), poids fort d'abord
+    const unsigned long long words[4] = {h1, h2, h3, h4};
+    uint8_t bytes[32];
+    for (size_t w = 0; w < 4; ++w) {
+        for (size_t j = 0; j < 8; ++j) {
+            bytes[8 * w + j] = static_cast<uint8_t>(words[w] >> (56 - 8 * j));
+        }
+    }
+    return hex::encode(bytes, sizeof(bytes));
 }
\ No newline at end of file
@@ -4,6 +4,8 @@
 #include <sstream>
 #include <ctime>
 #include "EX2.h"
+#include "block_header.h"
+#include "../common/mining.h"
 
 // ========== ENUM POUR MODE DE HACHAGE ==========
 enum class HashMode {
@@ -15,62 +17,114 @@ std::string hash_mode_to_string(HashMode mode) {
     return (mode == HashMode::SHA256) ? "SHA256" : "AC_HASH";
 }
 
+// ========== AFFICHAGE DU MINAGE ==========
+// Observateur console : un point tous les `interval` essais de chaque
+// thread, puis le bilan sur la meme ligne. Sans observateur, le minage
+// n'affiche rien pendant la recherche.
+class ConsoleProgress : public mining::MiningObserver {
+public:
+    explicit ConsoleProgress(unsigned long long interval = 10000) : MiningObserver(interval) {}
+    
+    void onProgress(const mining::MiningProgress&) override {
+        std::cout << "." << std::flush;
+    }
+    
+    void onFinish(const mining::MiningResult& result) override {
+        std::cout << " [" << result.totalHashes() << " essais, " << (long long)(result.seconds * 1000)
+                  << " ms, " << (long long)result.hashRate() << " H/s, "
+                  << result.threads() << " thread(s)]";
+    }
+};
+
 // ========== STRUCTURE BLOC ==========
 struct Block {
     int index;
     std::string timestamp;
+    uint64_t created;       // meme instant, en secondes (champ de l'en-tete)
     std::string data;
     std::string previous_hash;
-    int nonce;
+    uint32_t target_bits;   // bits de tete a zero exiges (fixe au minage)
+    uint64_t extra_nonce;   // incremente si tout l'espace des nonces est epuise
+    uint64_t nonce;
     std::string hash;
     HashMode hash_mode;
     
     Block(int idx, const std::string& d, const std::string& prev_hash, HashMode mode)
-        : index(idx), data(d), previous_hash(prev_hash), nonce(0), hash_mode(mode) {
-        timestamp = get_current_timestamp();
+        : index(idx), data(d), previous_hash(prev_hash), target_bits(0), extra_nonce(0), nonce(0),
+          hash_mode(mode) {
+        time_t now = time(0);
+        created = static_cast<uint64_t>(now);
+        timestamp = get_current_timestamp(now);
         hash = calculate_hash();
     }
     
-    std::string get_current_timestamp() {
-        time_t now = time(0);
+    std::string get_current_timestamp(time_t now) {
         char buf[80];
         strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", localtime(&now));
         return std::string(buf);
     }
     
-    std::string calculate_hash() {
-        std::stringstream ss;
-        ss << index << timestamp << data << previous_hash << nonce;
-        std::string block_content = ss.str();
-        
+    std::string calculate_hash() const {
+        return calculate_hash(nonce, extra_nonce);
+    }
+    
+    std::string hash_content(const std::string& content) const {
         if (hash_mode == HashMode::SHA256) {
-            return sha256_simple(block_content);
+            return sha256_simple(content);
         } else {
-            return ac_hash(block_content, 30, 250);
+            return ac_hash(content, 30, 250);
         }
     }
     
-    void mine_block(int difficulty) {
-        std::string target(difficulty, '0');
+    // En-tete binaire de taille fixe ; les donnees y sont engagees par leur hash
+    std::string encoded_header(uint64_t candidate, uint64_t extra) const {
+        BlockHeader header;
+        header.version = k_header_version;
+        header.index = static_cast<uint32_t>(index);
+        hash_from_hex(previous_hash, header.previous_hash);
+        hash_from_hex(hash_content(data), header.data_hash);
+        header.timestamp = created;
+        header.target = target_bits;
+        header.extra_nonce = extra;
+        header.nonce = candidate;
+        return encode_header(header);
+    }
+    
+    // Hash pour un nonce candidat
+    std::string calculate_hash(uint64_t candidate, uint64_t extra) const {
+        return hash_content(encoded_header(candidate, extra));
+    }
+    
+    // Minage sur tous les threads du pool, chacun sur sa tranche de nonces
+    // Difficulte en bits de tete a zero
+    void mine_block(uint32_t difficulty_bits, mining::MiningObserver* observer = nullptr,
+                    parallel::ThreadPool& pool = parallel::defaultPool()) {
+        Target target = target_from_bits(difficulty_bits);
         
         std::cout << "Minage du bloc #" << index << " en cours";
-        int progress = 0;
-        do {
-            nonce++;
-            hash = calculate_hash();
-            
-            // Affichage de progression tous les 10000 essais
-            if (nonce % 10000 == 0) {
-                std::cout << "." << std::flush;
-                progress++;
-                
-                // Limite de sécurité pour éviter boucle infinie
-                if (progress > 1000) {
-                    std::cout << "\n[ERREUR] Trop d'iterations, hash invalide!" << std::endl;
-                    return;
-                }
-            }
-        } while (hash.substr(0, difficulty) != target);
+        
+        // Limite de sécurité pour éviter boucle infinie : 10 millions d'essais
+        mining::MiningLimits limits;
+        limits.nonceSpace = 10000000;
+        limits.extraNonces = 1;
+        target_bits = difficulty_bits;
+        mining::MiningResult result = mining::mine([&](unsigned, uint64_t extra) {
+            // En-tete encode une fois par thread, seul le nonce est reecrit
+            std::string header = encoded_header(0, extra);
+            return [=](uint64_t candidate) mutable {
+                set_header_nonce(header, candidate);
+                return meets_target(hash_content(header), target);
+            };
+        }, limits, pool, observer);
+        
+        if (!result.found) {
+            std::cout << "\n[ERREUR] Trop d'iterations, hash invalide!" << std::endl;
+            return;
+        }
+        
+        extra_nonce = result.extraNonce;
+        nonce = result.nonce;
+        hash = calculate_hash();
         
         std::cout << " OK!" << std::endl;
         std::cout << "Hash: " << hash << std::endl;
@@ -93,16 +147,17 @@ struct Block {
 class Blockchain {
 private:
     std::vector<Block> chain;
-    int difficulty;
+    uint32_t difficulty_bits;   // bits de tete a zero exiges
     HashMode current_hash_mode;
+    mining::MiningObserver* observer;   // progression du minage (optionnel)
     
 public:
-    Blockchain(int diff = 2, HashMode mode = HashMode::SHA256) 
-        : difficulty(diff), current_hash_mode(mode) {
+    Blockchain(uint32_t diff_bits = 8, HashMode mode = HashMode::SHA256) 
+        : difficulty_bits(diff_bits), current_hash_mode(mode), observer(nullptr) {
         chain.emplace_back(0, "Genesis Block", "0", current_hash_mode);
         std::cout << "Blockchain initialisee avec " 
                   << hash_mode_to_string(current_hash_mode) 
-                  << " (difficulte: " << difficulty << ")" << std::endl;
+                  << " (difficulte: " << difficulty_bits << " bits)" << std::endl;
     }
     
     void set_hash_mode(HashMode mode) {
@@ -115,6 +170,10 @@ public:
         return current_hash_mode;
     }
     
+    void set_observer(mining::MiningObserver* mining_observer) {
+        observer = mining_observer;
+    }
+    
     Block& get_latest_block() {
         return chain.back();
     }
@@ -124,11 +183,12 @@ public:
                        get_latest_block().hash, 
                        current_hash_mode);
         
-        new_block.mine_block(difficulty);
+        new_block.mine_block(difficulty_bits, observer);
         chain.push_back(new_block);
     }
     
     bool is_chain_valid() {
+        Target target = target_from_bits(difficulty_bits);
         for (size_t i = 1; i < chain.size(); ++i) {
             Block& current = chain[i];
             Block& previous = chain[i - 1];
@@ -145,8 +205,7 @@ public:
                 return false;
             }
             
-            std::string target(difficulty, '0');
-            if (current.hash.substr(0, difficulty) != target) {
+            if (!meets_target(current.hash, target)) {
                 std::cout << "Erreur: Preuve de travail invalide pour le bloc #" 
                          << current.index << std::endl;
                 return false;
@@ -157,7 +216,7 @@ public:
     
     void print_chain() {
         std::cout << "\n========== BLOCKCHAIN ==========" << std::endl;
-        std::cout << "Difficulte: " << difficulty << std::endl;
+        std::cout << "Difficulte: " << difficulty_bits << " bits" << std::endl;
         std::cout << "Nombre de blocs: " << chain.size() << std::endl;
         
         for (const auto& block : chain) {
@@ -169,7 +228,9 @@ public:
 // ========== FONCTIONS DE TEST ==========
 void test_sha256_blockchain() {
     std::cout << "\n=== TEST BLOCKCHAIN AVEC SHA256 ===" << std::endl;
-    Blockchain bc(2, HashMode::SHA256);
+    Blockchain bc(8, HashMode::SHA256);
+    ConsoleProgress progress;
+    bc.set_observer(&progress);
     bc.add_block("Transaction 1: Alice -> Bob 50 BTC");
     bc.add_block("Transaction 2: Bob -> Charlie 30 BTC");
     
@@ -179,7 +240,9 @@ void test_sha256_blockchain() {
 
 void test_ac_hash_blockchain() {
     std::cout << "\n=== TEST BLOCKCHAIN AVEC AC_HASH ===" << std::endl;
-    Blockchain bc(2, HashMode::AC_HASH);
+    Blockchain bc(8, HashMode::AC_HASH);
+    ConsoleProgress progress;
+    bc.set_observer(&progress);
     bc.add_block("Transaction 1: Alice -> Bob 50 BTC");
     bc.add_block("Transaction 2: Bob -> Charlie 30 BTC");
     
@@ -191,7 +254,9 @@ void test_ac_hash_blockchain() {
 
 void test_mixed_blockchain() {
     std::cout << "\n=== TEST BLOCKCHAIN MIXTE ===" << std::endl;
-    Blockchain bc(2, HashMode::SHA256);
+    Blockchain bc(8, HashMode::SHA256);
+    ConsoleProgress progress;
+    bc.set_observer(&progress);
     bc.add_block("Bloc 1 avec SHA256");
     
     bc.set_hash_mode(HashMode::AC_HASH);
@@ -3,9 +3,10 @@
 #include <string>
 #include <sstream>
 #include <ctime>
-#include <chrono>
 #include <iomanip>
 #include "EX2.h"
+#include "block_header.h"
+#include "../common/mining.h"
 
 // ========== ENUM POUR MODE DE HACHAGE ==========
 enum class HashMode {
@@ -18,12 +19,25 @@ std::string hash_mode_to_string(HashMode mode) {
 }
 
 // ========== STRUCTURE POUR STATISTIQUES ==========
-struct MiningStats {
+// Alimentee par le bilan de chaque minage (observateur sans progression)
+struct MiningStats : public mining::MiningObserver {
     double total_time_ms;
     long long total_iterations;
     int blocks_mined;
+    unsigned threads;
     
-    MiningStats() : total_time_ms(0), total_iterations(0), blocks_mined(0) {}
+    MiningStats() : total_time_ms(0), total_iterations(0), blocks_mined(0), threads(0) {}
+    
+    void onFinish(const mining::MiningResult& result) override {
+        total_time_ms += result.seconds * 1000;
+        total_iterations += result.totalHashes();
+        blocks_mined++;
+        threads = result.threads();
+    }
+    
+    double hash_rate() const {
+        return total_time_ms > 0 ? total_iterations / (total_time_ms / 1000) : 0;
+    }
     
     double avg_time_per_block() const {
         return blocks_mined > 0 ? total_time_ms / blocks_mined : 0;
@@ -38,54 +52,80 @@ struct MiningStats {
 struct Block {
     int index;
     std::string timestamp;
+    uint64_t created;       // meme instant, en secondes (champ de l'en-tete)
     std::string data;
     std::string previous_hash;
-    int nonce;
+    uint32_t target_bits;   // bits de tete a zero exiges (fixe au minage)
+    uint64_t extra_nonce;   // incremente si tout l'espace des nonces est epuise
+    uint64_t nonce;
     std::string hash;
     HashMode hash_mode;
     
     Block(int idx, const std::string& d, const std::string& prev_hash, HashMode mode)
-        : index(idx), data(d), previous_hash(prev_hash), nonce(0), hash_mode(mode) {
-        timestamp = get_current_timestamp();
+        : index(idx), data(d), previous_hash(prev_hash), target_bits(0), extra_nonce(0), nonce(0),
+          hash_mode(mode) {
+        time_t now = time(0);
+        created = static_cast<uint64_t>(now);
+        timestamp = get_current_timestamp(now);
     }
     
-    std::string get_current_timestamp() {
-        time_t now = time(0);
+    std::string get_current_timestamp(time_t now) {
         char buf[80];
         strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", localtime(&now));
         return std::string(buf);
     }
     
-    std::string calculate_hash() {
-        std::stringstream ss;
-        ss << index << timestamp << data << previous_hash << nonce;
-        std::string block_content = ss.str();
-        
+    std::string calculate_hash() const {
+        return calculate_hash(nonce, extra_nonce);
+    }
+    
+    std::string hash_content(const std::string& content) const {
         if (hash_mode == HashMode::SHA256) {
-            return sha256_simple(block_content);
+            return sha256_simple(content);
         } else {
-            return ac_hash(block_content, 30, 250);
+            return ac_hash(content, 30, 250);
         }
     }
     
+    // En-tete binaire de taille fixe ; les donnees y sont engagees par leur hash
+    std::string encoded_header(uint64_t candidate, uint64_t extra) const {
+        BlockHeader header;
+        header.version = k_header_version;
+        header.index = static_cast<uint32_t>(index);
+        hash_from_hex(previous_hash, header.previous_hash);
+        hash_from_hex(hash_content(data), header.data_hash);
+        header.timestamp = created;
+        header.target = target_bits;
+        header.extra_nonce = extra;
+        header.nonce = candidate;
+        return encode_header(header);
+    }
+    
+    // Hash pour un nonce candidat
+    std::string calculate_hash(uint64_t candidate, uint64_t extra) const {
+        return hash_content(encoded_header(candidate, extra));
+    }
+    
     // 4.2. Version modifiée pour compter les itérations
-    long long mine_block_with_stats(int difficulty, double& time_taken_ms) {
-        std::string target(difficulty, '0');
-        long long iterations = 0;
-        
-        auto start = std::chrono::high_resolution_clock::now();
+    // Minage parallele : iterations = essais cumules de tous les threads,
+    // transmis avec le temps a l'observateur
+    mining::MiningResult mine_block_with_stats(uint32_t difficulty_bits, mining::MiningObserver* observer,
+                                               parallel::ThreadPool& pool = parallel::defaultPool()) {
+        Target target = target_from_bits(difficulty_bits);
         
-        do {
-            nonce++;
-            iterations++;
-            hash = calculate_hash();
-        } while (hash.substr(0, difficulty) != target);
-        
-        auto end = std::chrono::high_resolution_clock::now();
-        std::chrono::duration<double, std::milli> duration = end - start;
-        time_taken_ms = duration.count();
-        
-        return iterations;
+        target_bits = difficulty_bits;
+        mining::MiningResult result = mining::mine([&](unsigned, uint64_t extra) {
+            // En-tete encode une fois par thread, seul le nonce est reecrit
+            std::string header = encoded_header(0, extra);
+            return [=](uint64_t candidate) mutable {
+                set_header_nonce(header, candidate);
+                return meets_target(hash_content(header), target);
+            };
+        }, mining::MiningLimits(), pool, observer);
+        extra_nonce = result.extraNonce;
+        nonce = result.nonce;
+        hash = calculate_hash();
+        return result;
     }
 };
 
@@ -93,12 +133,12 @@ struct Block {
 class TestBlockchain {
 private:
     std::vector<Block> chain;
-    int difficulty;
+    uint32_t difficulty_bits;   // bits de tete a zero exiges
     HashMode current_hash_mode;
     
 public:
-    TestBlockchain(int diff, HashMode mode) 
-        : difficulty(diff), current_hash_mode(mode) {
+    TestBlockchain(uint32_t diff_bits, HashMode mode) 
+        : difficulty_bits(diff_bits), current_hash_mode(mode) {
         chain.emplace_back(0, "Genesis Block", "0", current_hash_mode);
     }
     
@@ -112,26 +152,21 @@ public:
                        get_latest_block().hash, 
                        current_hash_mode);
         
-        double time_ms;
-        long long iterations = new_block.mine_block_with_stats(difficulty, time_ms);
-        
-        stats.total_time_ms += time_ms;
-        stats.total_iterations += iterations;
-        stats.blocks_mined++;
+        mining::MiningResult result = new_block.mine_block_with_stats(difficulty_bits, &stats);
         
         chain.push_back(new_block);
         
         std::cout << "Bloc #" << new_block.index 
-                  << " - Temps: " << std::fixed << std::setprecision(2) << time_ms << " ms"
-                  << " - Iterations: " << iterations << std::endl;
+                  << " - Temps: " << std::fixed << std::setprecision(2) << result.seconds * 1000 << " ms"
+                  << " - Iterations: " << result.totalHashes() << std::endl;
     }
 };
 
 // ========== FONCTION DE TEST COMPARATIVE ==========
-void compare_hash_methods(int difficulty, int num_blocks) {
+void compare_hash_methods(uint32_t difficulty_bits, int num_blocks) {
     std::cout << "\n========================================" << std::endl;
     std::cout << "  COMPARAISON ac_hash vs SHA256" << std::endl;
-    std::cout << "  Difficulte: " << difficulty << std::endl;
+    std::cout << "  Difficulte: " << difficulty_bits << " bits" << std::endl;
     std::cout << "  Nombre de blocs: " << num_blocks << std::endl;
     std::cout << "========================================\n" << std::endl;
     
@@ -140,7 +175,7 @@ void compare_hash_methods(int difficulty, int num_blocks) {
     
     // Test avec SHA256
     std::cout << "--- Test avec SHA256 ---" << std::endl;
-    TestBlockchain bc_sha(difficulty, HashMode::SHA256);
+    TestBlockchain bc_sha(difficulty_bits, HashMode::SHA256);
     for (int i = 1; i <= num_blocks; i++) {
         std::stringstream ss;
         ss << "Transaction " << i << ": Test data";
@@ -148,7 +183,7 @@ void compare_hash_methods(int difficulty, int num_blocks) {
     }
     
     std::cout << "\n--- Test avec AC_HASH ---" << std::endl;
-    TestBlockchain bc_ac(difficulty, HashMode::AC_HASH);
+    TestBlockchain bc_ac(difficulty_bits, HashMode::AC_HASH);
     for (int i = 1; i <= num_blocks; i++) {
         std::stringstream ss;
         ss << "Transaction " << i << ": Test data";
@@ -185,6 +220,14 @@ void compare_hash_methods(int difficulty, int num_blocks) {
               << std::setw(20) << std::fixed << std::setprecision(0) << sha256_stats.avg_iterations_per_block()
               << std::setw(20) << std::fixed << std::setprecision(0) << ac_hash_stats.avg_iterations_per_block() << std::endl;
     
+    std::cout << std::left << std::setw(25) << "Debit (H/s)" 
+              << std::setw(20) << std::fixed << std::setprecision(0) << sha256_stats.hash_rate()
+              << std::setw(20) << std::fixed << std::setprecision(0) << ac_hash_stats.hash_rate() << std::endl;
+    
+    std::cout << std::left << std::setw(25) << "Threads" 
+              << std::setw(20) << sha256_stats.threads
+              << std::setw(20) << ac_hash_stats.threads << std::endl;
+    
     std::cout << std::string(65, '-') << std::endl;
     
     // Comparaison relative
@@ -209,15 +252,15 @@ void run_comprehensive_tests() {
     std::cout << "  EXERCICE 4 - ANALYSE COMPARATIVE" << std::endl;
     std::cout << "=======================================" << std::endl;
     
-    // Test 1: Difficulté faible (2)
-    compare_hash_methods(2, 10);
+    // Test 1: Difficulté faible (8 bits, 2 zeros hexadecimaux)
+    compare_hash_methods(8, 10);
     
-    // Test 2: Difficulté moyenne (3)
+    // Test 2: Difficulté moyenne (12 bits)
     std::cout << "\n\n";
-    compare_hash_methods(3, 10);
+    compare_hash_methods(12, 10);
     
-    // Test optionnel: Difficulté élevée (4) - Attention, peut être long!
-    // compare_hash_methods(4, 5);
+    // Test optionnel: Difficulté élevée (16 bits) - Attention, peut être long!
+    // compare_hash_methods(16, 5);
 }
 
 // ========== MAIN ==========
@@ -7,30 +7,13 @@
 #include <ctime>
 #include <cmath>  // Pour fabs()
 #include "EX2.h"
+#include "../common/hex.h"
 
 // ========== FONCTIONS UTILITAIRES ==========
 
 // Convertir un hash hexadécimal en bits
 std::vector<bool> hex_to_bits(const std::string& hex_hash) {
-    std::vector<bool> bits;
-    for (char c : hex_hash) {
-        int val;
-        if (c >= '0' && c <= '9') {
-            val = c - '0';
-        } else if (c >= 'a' && c <= 'f') {
-            val = c - 'a' + 10;
-        } else if (c >= 'A' && c <= 'F') {
-            val = c - 'A' + 10;
-        } else {
-            continue;
-        }
-        
-        // Convertir chaque caractère hex en 4 bits
-        for (int i = 3; i >= 0; --i) {
-            bits.push_back((val >> i) & 1);
-        }
-    }
-    return bits;
+    return hex::to_bits(hex_hash);
 }
 
 // Générer un message aléatoire
@@ -0,0 +1,140 @@
+#ifndef ATELIER2_BLOCK_HEADER_H
+#define ATELIER2_BLOCK_HEADER_H
+
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include "../common/hex.h"
+
+// En-tete de bloc binaire a disposition fixe (100 octets, entiers en
+// petit-boutiste, hashes en 32 octets bruts), meme disposition qu'en Atelier1 :
+//
+//   offset  taille  champ
+//        0       4  version
+//        4       4  index
+//        8      32  previous_hash
+//       40      32  data_hash     (hash des donnees du bloc)
+//       72       8  timestamp     (secondes depuis l'epoque Unix)
+//       80       4  target        (bits de tete a zero exiges)
+//       84       8  extra_nonce
+//       92       8  nonce
+//
+// Le contenu hache a toujours la meme taille et le nonce se reecrit en
+// place : plus de stringstream ni de formatage decimal pendant le minage.
+const size_t k_header_size = 100;
+const size_t k_header_nonce_offset = 92;
+const uint32_t k_header_version = 1;
+
+struct BlockHeader {
+    uint32_t version;
+    uint32_t index;
+    uint8_t previous_hash[32];
+    uint8_t data_hash[32];
+    uint64_t timestamp;
+    uint32_t target;
+    uint64_t extra_nonce;
+    uint64_t nonce;
+};
+
+inline void store_le(uint8_t* out, uint64_t value, size_t width) {
+    for (size_t i = 0; i < width; i++) {
+        out[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+}
+
+inline uint64_t load_le(const uint8_t* in, size_t width) {
+    uint64_t value = 0;
+    for (size_t i = width; i-- > 0; ) {
+        value = (value << 8) | in[i];
+    }
+    return value;
+}
+
+// Hash hexadecimal (64 caracteres) -> 32 octets ; zeros si invalide
+// (le "0" du bloc genesis par exemple)
+inline void hash_from_hex(const std::string& hex_hash, uint8_t* out) {
+    if (hex_hash.size() != 64 || !hex::decode(hex_hash.data(), 32, out)) {
+        std::memset(out, 0, 32);
+    }
+}
+
+// Ecrit l'en-tete dans une chaine de k_header_size octets (les fonctions
+// de hachage de l'atelier prennent une std::string)
+inline std::string encode_header(const BlockHeader& header) {
+    uint8_t out[k_header_size];
+    store_le(out, header.version, 4);
+    store_le(out + 4, header.index, 4);
+    std::memcpy(out + 8, header.previous_hash, 32);
+    std::memcpy(out + 40, header.data_hash, 32);
+    store_le(out + 72, header.timestamp, 8);
+    store_le(out + 80, header.target, 4);
+    store_le(out + 84, header.extra_nonce, 8);
+    store_le(out + k_header_nonce_offset, header.nonce, 8);
+    return std::string(reinterpret_cast<const char*>(out), sizeof(out));
+}
+
+// Retourne false si la taille ou la version ne correspondent pas
+inline bool decode_header(const std::string& bytes, BlockHeader& header) {
+    const uint8_t* in = reinterpret_cast<const uint8_t*>(bytes.data());
+    if (bytes.size() != k_header_size || load_le(in, 4) != k_header_version) {
+        return false;
+    }
+    header.version = static_cast<uint32_t>(load_le(in, 4));
+    header.index = static_cast<uint32_t>(load_le(in + 4, 4));
+    std::memcpy(header.previous_hash, in + 8, 32);
+    std::memcpy(header.data_hash, in + 40, 32);
+    header.timestamp = load_le(in + 72, 8);
+    header.target = static_cast<uint32_t>(load_le(in + 80, 4));
+    header.extra_nonce = load_le(in + 84, 8);
+    header.nonce = load_le(in + k_header_nonce_offset, 8);
+    return true;
+}
+
+// Cible de preuve de travail : entier de 256 bits en 8 mots, poids fort en
+// premier. Un hash est valide s'il est inferieur ou egal a la cible.
+struct Target {
+    uint32_t words[8];
+};
+
+// Cible exigeant `bits` bits de tete a zero (chaque bit double le travail,
+// un zero hexadecimal vaut 4 bits)
+inline Target target_from_bits(uint32_t bits) {
+    Target target;
+    for (uint32_t i = 0; i < 8; i++) {
+        uint32_t first = 32 * i;
+        target.words[i] = bits >= first + 32 ? 0 : bits <= first ? 0xffffffffu : 0xffffffffu >> (bits - first);
+    }
+    return target;
+}
+
+// Compare un hash hexadecimal (64 caracteres) a la cible, mot de 32 bits
+// par mot de 32 bits, sans allocation : on s'arrete au premier mot qui
+// differe, presque toujours le premier. Un hash mal forme est refuse.
+inline bool meets_target(const std::string& hex_hash, const Target& target) {
+    if (hex_hash.size() != 64) {
+        return false;
+    }
+    for (size_t w = 0; w < 8; w++) {
+        uint32_t word = 0;
+        for (size_t i = 8 * w; i < 8 * w + 8; i++) {
+            uint8_t value = hex::k_values[static_cast<uint8_t>(hex_hash[i])];
+            if (value == 0xff) {
+                return false;
+            }
+            word = (word << 4) | value;
+        }
+        if (word != target.words[w]) {
+            return word < target.words[w];
+        }
+    }
+    return true;
+}
+
+// Reecrit le nonce d'un en-tete encode, sans reallocation
+inline void set_header_nonce(std::string& encoded, uint64_t nonce) {
+    uint8_t bytes[8];
+    store_le(bytes, nonce, 8);
+    encoded.replace(k_header_nonce_offset, 8, reinterpret_cast<const char*>(bytes), 8);
+}
+
+#endif
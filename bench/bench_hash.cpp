@@ -0,0 +1,306 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <functional>
+#include <algorithm>
+#include <cstdlib>
+#include <cstdint>
+#include "../Atelier1/picosha2.h"
+#include "../Atelier2/EX2.h"
+
+using namespace std;
+using namespace chrono;
+
+// Paramètres de la campagne (modifiables en ligne de commande)
+struct BenchConfig {
+    uint32_t rule = 30;                 // règle de l'automate pour ac_hash
+    size_t steps = 100;                 // générations pour ac_hash
+    vector<unsigned> threads = {1, max(1u, thread::hardware_concurrency())};
+    vector<size_t> sizes = {32, 64, 256, 1024, 4096, 65536, 1 << 20};
+    vector<string> engines = {"picosha2", "picosha2_sha256d", "sha256_simple", "ac_hash"};
+    int warmup = 1;                     // répétitions non mesurées
+    int repetitions = 5;                // répétitions mesurées
+    double minTime = 0.1;               // durée minimale d'une répétition (s)
+    size_t acMaxSize = 65536;           // ac_hash est O(taille x steps) : au-delà, ignoré
+    string jsonPath;                    // vide = pas de JSON, "-" = sortie standard
+};
+
+// Un moteur de hachage mesuré ; renvoie un octet du résultat pour
+// empêcher le compilateur d'éliminer l'appel
+struct Engine {
+    string name;
+    function<unsigned char(const string&)> hash;
+    size_t maxSize;
+};
+
+struct BenchResult {
+    string engine;
+    size_t size;
+    unsigned threads;
+    int repetitions;
+    double latencyNsMin;        // latence d'un hash sur un thread
+    double latencyNsMedian;
+    double hashesPerSec;        // débit cumulé de tous les threads (médiane)
+    double bytesPerSec;
+};
+
+vector<Engine> makeEngines(const BenchConfig& config) {
+    vector<Engine> all;
+    all.push_back({"picosha2", [](const string& m) {
+        picosha2::byte_t hash[picosha2::k_digest_size];
+        picosha2::calc_hash(m.begin(), m.end(), hash);
+        return hash[0];
+    }, SIZE_MAX});
+    all.push_back({"picosha2_sha256d", [](const string& m) {
+        picosha2::byte_t hash[picosha2::k_digest_size];
+        picosha2::calc_hash256d(m.begin(), m.end(), hash);
+        return hash[0];
+    }, SIZE_MAX});
+    all.push_back({"sha256_simple", [](const string& m) {
+        return static_cast<unsigned char>(sha256_simple(m)[0]);
+    }, SIZE_MAX});
+    uint32_t rule = config.rule;
+    size_t steps = config.steps;
+    all.push_back({"ac_hash", [rule, steps](const string& m) {
+        return static_cast<unsigned char>(ac_hash(m, rule, steps)[0]);
+    }, config.acMaxSize});
+
+    vector<Engine> selected;
+    for(const auto& name : config.engines) {
+        for(const auto& e : all) {
+            if(e.name == name) {
+                selected.push_back(e);
+            }
+        }
+    }
+    return selected;
+}
+
+// Une répétition : chaque thread hache son propre message pendant au moins
+// minTime secondes. Renvoie la durée écoulée et le nombre total de hashes.
+double runRepetition(const Engine& engine, const vector<string>& messages, unsigned threads,
+                     double minTime, unsigned long long& totalHashes) {
+    vector<unsigned long long> counts(threads, 0);
+    vector<unsigned> sinks(threads, 0);
+    vector<thread> workers;
+
+    auto start = steady_clock::now();
+    for(unsigned t = 0; t < threads; t++) {
+        workers.emplace_back([&, t]() {
+            const string& message = messages[t];
+            unsigned long long n = 0;
+            unsigned sink = 0;
+            // Vérifier l'horloge par paquets pour ne pas mesurer steady_clock
+            unsigned long long batch = 1;
+            while(true) {
+                for(unsigned long long i = 0; i < batch; i++) {
+                    sink += engine.hash(message);
+                }
+                n += batch;
+                duration<double> elapsed = steady_clock::now() - start;
+                if(elapsed.count() >= minTime) {
+                    break;
+                }
+                batch = min<unsigned long long>(batch * 2, 1024);
+            }
+            counts[t] = n;
+            sinks[t] = sink;
+        });
+    }
+    for(auto& w : workers) {
+        w.join();
+    }
+    duration<double> elapsed = steady_clock::now() - start;
+
+    totalHashes = 0;
+    unsigned sink = 0;
+    for(unsigned t = 0; t < threads; t++) {
+        totalHashes += counts[t];
+        sink += sinks[t];
+    }
+    volatile unsigned keep = sink;
+    (void)keep;
+    return elapsed.count();
+}
+
+double median(vector<double> values) {
+    sort(values.begin(), values.end());
+    size_t mid = values.size() / 2;
+    return (values.size() % 2) ? values[mid] : (values[mid - 1] + values[mid]) / 2;
+}
+
+BenchResult benchmark(const Engine& engine, size_t size, unsigned threads, const BenchConfig& config, mt19937& rng) {
+    // Messages aléatoires distincts par thread
+    vector<string> messages(threads, string(size, '\0'));
+    for(auto& m : messages) {
+        for(auto& c : m) {
+            c = static_cast<char>(rng());
+        }
+    }
+
+    unsigned long long hashes = 0;
+    for(int r = 0; r < config.warmup; r++) {
+        runRepetition(engine, messages, threads, config.minTime, hashes);
+    }
+
+    vector<double> latencies, rates;
+    for(int r = 0; r < config.repetitions; r++) {
+        double elapsed = runRepetition(engine, messages, threads, config.minTime, hashes);
+        latencies.push_back(elapsed * threads / hashes * 1e9);
+        rates.push_back(hashes / elapsed);
+    }
+
+    BenchResult result;
+    result.engine = engine.name;
+    result.size = size;
+    result.threads = threads;
+    result.repetitions = config.repetitions;
+    result.latencyNsMin = *min_element(latencies.begin(), latencies.end());
+    result.latencyNsMedian = median(latencies);
+    result.hashesPerSec = median(rates);
+    result.bytesPerSec = result.hashesPerSec * size;
+    return result;
+}
+
+void writeJson(ostream& os, const BenchConfig& config, const vector<BenchResult>& results) {
+    os << "{\n";
+    os << "  \"config\": {\"rule\": " << config.rule << ", \"steps\": " << config.steps
+       << ", \"warmup\": " << config.warmup << ", \"repetitions\": " << config.repetitions
+       << ", \"min_time_s\": " << config.minTime
+       << ", \"sha_ni\": " << (picosha2::sha_ni_enabled() ? "true" : "false")
+       << ", \"hardware_threads\": " << thread::hardware_concurrency() << "},\n";
+    os << "  \"results\": [\n";
+    os << fixed << setprecision(3);     // pas de notation scientifique ni de chiffres perdus
+    for(size_t i = 0; i < results.size(); i++) {
+        const BenchResult& r = results[i];
+        os << "    {\"engine\": \"" << r.engine << "\", \"size\": " << r.size
+           << ", \"threads\": " << r.threads << ", \"repetitions\": " << r.repetitions
+           << ", \"latency_ns_min\": " << r.latencyNsMin
+           << ", \"latency_ns_median\": " << r.latencyNsMedian
+           << ", \"hashes_per_sec\": " << r.hashesPerSec
+           << ", \"bytes_per_sec\": " << r.bytesPerSec << "}"
+           << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    os << "  ]\n}\n";
+}
+
+template<typename T>
+vector<T> parseList(const string& text) {
+    vector<T> values;
+    stringstream ss(text);
+    string item;
+    while(getline(ss, item, ',')) {
+        stringstream is(item);
+        T value;
+        if(is >> value) {
+            values.push_back(value);
+        }
+    }
+    return values;
+}
+
+void usage(const char* program) {
+    cerr << "Usage: " << program << " [options]\n"
+         << "  --engines a,b,..   picosha2, picosha2_sha256d, sha256_simple, ac_hash\n"
+         << "  --sizes n,..       tailles des messages en octets\n"
+         << "  --threads n,..     nombres de threads\n"
+         << "  --rule N           règle de l'automate (ac_hash)\n"
+         << "  --steps N          générations (ac_hash)\n"
+         << "  --ac-max-size N    taille maximale testée pour ac_hash\n"
+         << "  --warmup N         répétitions d'échauffement\n"
+         << "  --reps N           répétitions mesurées\n"
+         << "  --min-time S       durée minimale d'une répétition\n"
+         << "  --json FICHIER     résultats JSON (\"-\" = sortie standard)" << endl;
+}
+
+int main(int argc, char* argv[]) {
+    BenchConfig config;
+    for(int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if(i + 1 >= argc) {
+            usage(argv[0]);
+            return 1;
+        }
+        string value = argv[++i];
+        if(arg == "--engines") config.engines = parseList<string>(value);
+        else if(arg == "--sizes") config.sizes = parseList<size_t>(value);
+        else if(arg == "--threads") config.threads = parseList<unsigned>(value);
+        else if(arg == "--rule") config.rule = static_cast<uint32_t>(atoi(value.c_str()));
+        else if(arg == "--steps") config.steps = static_cast<size_t>(atoll(value.c_str()));
+        else if(arg == "--ac-max-size") config.acMaxSize = static_cast<size_t>(atoll(value.c_str()));
+        else if(arg == "--warmup") config.warmup = atoi(value.c_str());
+        else if(arg == "--reps") config.repetitions = max(1, atoi(value.c_str()));
+        else if(arg == "--min-time") config.minTime = atof(value.c_str());
+        else if(arg == "--json") config.jsonPath = value;
+        else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    // Chaque nombre de threads une seule fois (1 et hardware_concurrency()
+    // coïncident sur une machine à un coeur)
+    for(unsigned& threads : config.threads) {
+        threads = max(1u, threads);
+    }
+    sort(config.threads.begin(), config.threads.end());
+    config.threads.erase(unique(config.threads.begin(), config.threads.end()), config.threads.end());
+
+    // Avec --json -, le tableau lisible part sur stderr
+    ostream& out = (config.jsonPath == "-") ? cerr : cout;
+    out << "========================================" << endl;
+    out << "  BENCHMARK DES FONCTIONS DE HACHAGE" << endl;
+    out << "========================================" << endl;
+    out << "ac_hash: règle " << config.rule << ", " << config.steps << " générations" << endl;
+
+    mt19937 rng(42);
+    vector<BenchResult> results;
+    for(const Engine& engine : makeEngines(config)) {
+        out << "\n--- " << engine.name << " ---" << endl;
+        out << "  " << right << setw(9) << "taille" << setw(9) << "threads" << setw(14) << "latence (ns)"
+            << setw(14) << "hash/s" << setw(12) << "MB/s" << endl;
+        for(size_t size : config.sizes) {
+            if(size > engine.maxSize) {
+                out << "  " << setw(9) << size << "  ignoré (--ac-max-size " << engine.maxSize << ")" << endl;
+                continue;
+            }
+            for(unsigned threads : config.threads) {
+                BenchResult r = benchmark(engine, size, threads, config, rng);
+                results.push_back(r);
+                out << "  " << setw(9) << r.size << setw(9) << r.threads
+                    << setw(14) << fixed << setprecision(1) << r.latencyNsMedian
+                    << setw(14) << setprecision(0) << r.hashesPerSec
+                    << setw(12) << setprecision(1) << r.bytesPerSec / 1e6 << endl;
+            }
+        }
+    }
+
+    if(config.jsonPath == "-") {
+        writeJson(cout, config, results);
+    } else if(!config.jsonPath.empty()) {
+        ofstream file(config.jsonPath);
+        if(!file) {
+            cerr << "Erreur: impossible d'écrire " << config.jsonPath << endl;
+            return 1;
+        }
+        writeJson(file, config, results);
+        out << "\nRésultats JSON écrits dans " << config.jsonPath << endl;
+    }
+
+    return 0;
+}
+
+/*
+COMPILATION:
+g++ -O2 -o bench_hash bench_hash.cpp ../Atelier2/EX1.cpp ../Atelier2/EX2.cpp -std=c++14 -pthread
+
+EXECUTION:
+./bench_hash --json results.json
+./bench_hash --engines ac_hash --rule 110 --steps 200 --sizes 32,1024 --threads 1
+*/
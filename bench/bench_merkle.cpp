@@ -0,0 +1,139 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <iomanip>
+#include <chrono>
+#include <algorithm>
+#include "../Atelier1/merkle.h"
+
+using namespace std;
+using namespace chrono;
+
+// Racine de Merkle : feuilles par lots puis niveaux successifs, sur `pool`
+Hash256 merkleRoot(const vector<string>& transactions, parallel::ThreadPool& pool) {
+    vector<Hash256> level = sha256HashBatch(transactions, pool);
+    while(level.size() > 1) {
+        level = merkleParentLevel(level, pool);
+    }
+    return level.empty() ? Hash256::zero() : level[0];
+}
+
+// Référence série, sans lots ni pool
+Hash256 merkleRootSerial(const vector<string>& transactions) {
+    vector<Hash256> level;
+    for(const auto& tx : transactions) {
+        level.push_back(sha256Hash(tx));
+    }
+    while(level.size() > 1) {
+        vector<Hash256> next;
+        for(size_t i = 0; i < level.size(); i += 2) {
+            next.push_back(hashPair(level[i], (i + 1 < level.size()) ? level[i + 1] : level[i]));
+        }
+        level = next;
+    }
+    return level.empty() ? Hash256::zero() : level[0];
+}
+
+int main() {
+    cout << "========================================" << endl;
+    cout << "  BENCHMARK RACINE DE MERKLE PARALLÈLE" << endl;
+    cout << "========================================" << endl;
+
+    unsigned maxThreads = max(1u, thread::hardware_concurrency());
+    vector<unsigned> threadCounts;
+    for(unsigned t = 1; t < maxThreads; t *= 2) {
+        threadCounts.push_back(t);
+    }
+    threadCounts.push_back(maxThreads);
+
+    for(size_t count : {1000, 3001, 50000, 200000}) {
+        vector<string> transactions;
+        for(size_t i = 0; i < count; i++) {
+            transactions.push_back("TX" + to_string(i) + ": Alice -> Bob " + to_string(i % 997) + "€");
+        }
+        Hash256 expected = merkleRootSerial(transactions);
+
+        cout << "\n--- " << count << " transactions ---" << endl;
+        double reference = 0;
+        for(unsigned threads : threadCounts) {
+            parallel::ThreadPool pool(threads);
+            Hash256 root = merkleRoot(transactions, pool);   // échauffement + contrôle
+            if(root != expected) {
+                cout << "❌ Racine différente avec " << threads << " threads" << endl;
+                return 1;
+            }
+
+            // Appels imbriqués : chaque tâche du pool recalcule la racine sur
+            // ce même pool, y compris celles exécutées par le thread appelant
+            vector<Hash256> nested(2 * threads);
+            pool.run(nested.size(), [&](size_t i) { nested[i] = merkleRoot(transactions, pool); });
+            if(count_if(nested.begin(), nested.end(), [&](const Hash256& h) { return h != expected; }) > 0) {
+                cout << "❌ Racine différente en appel imbriqué avec " << threads << " threads" << endl;
+                return 1;
+            }
+
+            int repetitions = (int)max<size_t>(3, 2000000 / count);
+            auto start = high_resolution_clock::now();
+            for(int r = 0; r < repetitions; r++) {
+                root = merkleRoot(transactions, pool);
+            }
+            duration<double, milli> elapsed = high_resolution_clock::now() - start;
+            double ms = elapsed.count() / repetitions;
+            if(threads == 1) {
+                reference = ms;
+            }
+            cout << "  " << setw(3) << threads << " threads: " << fixed << setprecision(3) << setw(10) << ms
+                 << " ms   accélération x" << setprecision(2) << reference / ms << endl;
+        }
+    }
+    cout << "\n✅ Racines identiques à la référence série (appels imbriqués compris)" << endl;
+
+    // Vérification de preuves : une par une, puis groupée (lots SIMD + pool)
+    size_t leafCount = 1 << 16;
+    vector<Hash256> level(leafCount);
+    for(size_t i = 0; i < leafCount; i++) {
+        level[i] = sha256Hash("TX" + to_string(i));
+    }
+    vector<vector<Hash256>> levels(1, level);
+    while(levels.back().size() > 1) {
+        levels.push_back(merkleParentLevel(levels.back()));
+    }
+    Hash256 root = levels.back()[0];
+    vector<MerkleProof> proofs(leafCount);
+    for(size_t i = 0; i < leafCount; i++) {
+        proofs[i].leafIndex = i;
+        for(size_t l = 0, index = i; l + 1 < levels.size(); l++, index /= 2) {
+            proofs[i].siblings.push_back(levels[l][(index ^ 1) < levels[l].size() ? (index ^ 1) : index]);
+        }
+    }
+
+    cout << "\n--- Vérification de " << leafCount << " preuves ---" << endl;
+    auto start = high_resolution_clock::now();
+    size_t valid = 0;
+    for(size_t i = 0; i < leafCount; i++) {
+        valid += verifyMerkleProof(level[i], proofs[i], root);
+    }
+    duration<double> single = high_resolution_clock::now() - start;
+
+    start = high_resolution_clock::now();
+    vector<char> results = verifyMerkleProofs(level, proofs, root);
+    duration<double> batched = high_resolution_clock::now() - start;
+    size_t validBatch = count(results.begin(), results.end(), 1);
+
+    if(valid != leafCount || validBatch != leafCount) {
+        cout << "❌ Preuves rejetées: " << leafCount - valid << " / " << leafCount - validBatch << endl;
+        return 1;
+    }
+    cout << "  une par une: " << fixed << setprecision(0) << setw(12) << leafCount / single.count() << " preuves/s" << endl;
+    cout << "  groupée:     " << setw(12) << leafCount / batched.count() << " preuves/s" << endl;
+    cout << "✅ Toutes les preuves sont valides" << endl;
+    return 0;
+}
+
+/*
+COMPILATION:
+g++ -O2 -o bench_merkle bench_merkle.cpp -std=c++14 -pthread
+
+EXECUTION:
+./bench_merkle
+*/
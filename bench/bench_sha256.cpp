@@ -0,0 +1,150 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include "../Atelier1/picosha2.h"
+
+using namespace std;
+using namespace chrono;
+
+// Génère `count` messages aléatoires de `size` octets
+vector<string> randomMessages(size_t count, size_t size, mt19937& rng) {
+    vector<string> messages(count, string(size, '\0'));
+    for(auto& m : messages) {
+        for(auto& c : m) {
+            c = static_cast<char>(rng());
+        }
+    }
+    return messages;
+}
+
+// Débit du hachage par lots pour une largeur de lanes donnée
+void benchBatch(const vector<string>& messages, size_t lanes, int repetitions) {
+    vector<picosha2::byte_t> hashes;
+    picosha2::hash256_batch(messages, hashes, lanes);  // échauffement
+
+    auto start = high_resolution_clock::now();
+    for(int r = 0; r < repetitions; r++) {
+        picosha2::hash256_batch(messages, hashes, lanes);
+    }
+    duration<double> elapsed = high_resolution_clock::now() - start;
+
+    double totalHashes = (double)messages.size() * repetitions;
+    double totalBytes = totalHashes * messages[0].size();
+
+    cout << "  " << left << setw(14) << (lanes == 1 ? "calc_hash x1" : lanes == 8 ? "AVX2 x8" : "AVX-512 x16")
+         << right << setw(12) << fixed << setprecision(3) << totalBytes / elapsed.count() / 1e9 << " GB/s"
+         << setw(14) << setprecision(0) << totalHashes / elapsed.count() << " hash/s" << endl;
+}
+
+// Vérifie que chaque largeur donne les mêmes digests que calc_hash
+bool checkBatch(const vector<string>& messages, size_t lanes) {
+    vector<picosha2::byte_t> hashes;
+    picosha2::hash256_batch(messages, hashes, lanes);
+    for(size_t i = 0; i < messages.size(); i++) {
+        picosha2::byte_t expected[picosha2::k_digest_size];
+        picosha2::calc_hash(messages[i].begin(), messages[i].end(), expected);
+        if(!equal(expected, expected + picosha2::k_digest_size, hashes.begin() + i * picosha2::k_digest_size)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Débit d'un flux unique (hash256_hex_string) avec ou sans SHA-NI
+void benchSingleStream(const string& message, bool shaNi, int repetitions) {
+    picosha2::use_sha_ni(shaNi);
+    string hex;
+    auto start = high_resolution_clock::now();
+    for(int r = 0; r < repetitions; r++) {
+        picosha2::hash256_hex_string(message, hex);
+    }
+    duration<double> elapsed = high_resolution_clock::now() - start;
+    picosha2::use_sha_ni(true);
+
+    double totalBytes = (double)message.size() * repetitions;
+    cout << "  " << left << setw(14) << (shaNi ? "SHA-NI" : "portable")
+         << right << setw(12) << fixed << setprecision(3) << totalBytes / elapsed.count() / 1e9 << " GB/s"
+         << setw(14) << setprecision(0) << repetitions / elapsed.count() << " hash/s" << endl;
+}
+
+// Compare SHA-NI et la compression portable sur des entrées aléatoires
+bool crossCheckShaNi(mt19937& rng, int samples) {
+    for(int i = 0; i < samples; i++) {
+        string message = randomMessages(1, rng() % 1000, rng)[0];
+        picosha2::use_sha_ni(true);
+        string accelerated = picosha2::hash256_hex_string(message);
+        picosha2::use_sha_ni(false);
+        string portable = picosha2::hash256_hex_string(message);
+        picosha2::use_sha_ni(true);
+        if(accelerated != portable) {
+            cout << "❌ Divergence SHA-NI / portable pour " << message.size() << " octets" << endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+int main() {
+    cout << "========================================" << endl;
+    cout << "  BENCHMARK SHA-256 (SHA-NI ET LOTS SIMD)" << endl;
+    cout << "========================================" << endl;
+
+    mt19937 rng(42);
+    vector<size_t> laneWidths;
+    for(size_t lanes : {1, 8, 16}) {
+        if(picosha2::hash256_batch_supported(lanes)) {
+            laneWidths.push_back(lanes);
+        }
+    }
+    cout << "Largeur choisie automatiquement: " << picosha2::hash256_batch_default_lanes() << " lanes" << endl;
+
+    // Contrôle de cohérence avec des tailles variées dans un même lot
+    vector<string> mixed;
+    for(size_t size = 0; size < 300; size++) {
+        mixed.push_back(randomMessages(1, size, rng)[0]);
+    }
+    for(size_t lanes : laneWidths) {
+        if(!checkBatch(mixed, lanes)) {
+            cout << "❌ Digests incorrects pour " << lanes << " lanes" << endl;
+            return 1;
+        }
+    }
+    cout << "✅ Digests identiques pour toutes les largeurs" << endl;
+
+    // Compression sur un seul flux : SHA-NI contre la boucle portable
+    cout << "\nSHA-NI disponible: " << (picosha2::sha_ni_enabled() ? "OUI" : "NON") << endl;
+    if(picosha2::sha_ni_enabled()) {
+        if(!crossCheckShaNi(rng, 5000)) {
+            return 1;
+        }
+        cout << "✅ SHA-NI et portable identiques sur 5000 entrées aléatoires" << endl;
+        for(size_t size : {64, 1024, 1 << 20}) {
+            string message = randomMessages(1, size, rng)[0];
+            int repetitions = (int)max<size_t>(20, (64 << 20) / size);
+            cout << "\n--- Flux unique de " << size << " octets ---" << endl;
+            benchSingleStream(message, false, repetitions);
+            benchSingleStream(message, true, repetitions);
+        }
+    }
+
+    for(size_t size : {32, 64, 256, 1024}) {
+        vector<string> messages = randomMessages(4096, size, rng);
+        cout << "\n--- Messages de " << size << " octets (" << messages.size() << " par lot) ---" << endl;
+        for(size_t lanes : laneWidths) {
+            benchBatch(messages, lanes, 20);
+        }
+    }
+
+    return 0;
+}
+
+/*
+COMPILATION:
+g++ -O2 -o bench_sha256 bench_sha256.cpp -std=c++11
+
+EXECUTION:
+./bench_sha256
+*/
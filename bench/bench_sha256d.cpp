@@ -0,0 +1,111 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include "../Atelier1/picosha2.h"
+#include "../common/hex.h"
+
+using namespace std;
+using namespace chrono;
+
+typedef void (*Sha256dFunction)(const string& data, picosha2::byte_t* out);
+
+// Méthode naïve : premier hash en hexadécimal, décodé avant le second tour
+void sha256dViaHex(const string& data, picosha2::byte_t* out) {
+    string hex = picosha2::hash256_hex_string(data);
+    string digest;
+    for(size_t i = 0; i < hex.size(); i += 2) {
+        digest += static_cast<char>(stoi(hex.substr(i, 2), nullptr, 16));
+    }
+    picosha2::calc_hash(digest.begin(), digest.end(), out);
+}
+
+// Deux appels génériques au hasher (padding générique au second tour)
+void sha256dGeneric(const string& data, picosha2::byte_t* out) {
+    picosha2::byte_t first[picosha2::k_digest_size];
+    picosha2::calc_hash(data.begin(), data.end(), first);
+    picosha2::calc_hash(first, first + picosha2::k_digest_size, out);
+}
+
+// Noyau fusionné : second tour sur un bloc déjà paddé
+void sha256dFused(const string& data, picosha2::byte_t* out) {
+    picosha2::calc_hash256d(data.begin(), data.end(), out);
+}
+
+double benchHashRate(Sha256dFunction fn, const vector<string>& messages, int repetitions) {
+    picosha2::byte_t out[picosha2::k_digest_size];
+    auto start = high_resolution_clock::now();
+    for(int r = 0; r < repetitions; r++) {
+        for(const auto& m : messages) {
+            fn(m, out);
+        }
+    }
+    duration<double> elapsed = high_resolution_clock::now() - start;
+    return messages.size() * (double)repetitions / elapsed.count();
+}
+
+string fromHex(const string& hexString) {
+    string bytes(hexString.size() / 2, '\0');
+    hex::decode(hexString.data(), bytes.size(), reinterpret_cast<uint8_t*>(&bytes[0]));
+    return bytes;
+}
+
+int main() {
+    cout << "========================================" << endl;
+    cout << "  BENCHMARK DOUBLE SHA-256 (sha256d)" << endl;
+    cout << "========================================" << endl;
+
+    // Vecteur de test : en-tête du bloc genesis de Bitcoin (80 octets)
+    string genesis = fromHex(
+        "0100000000000000000000000000000000000000000000000000000000000000"
+        "000000003ba3edfd7a7b12b27ac72c3e67768f617fc81bc3888a51323a9fb8aa"
+        "4b1e5e4a29ab5f49ffff001d1dac2b7c");
+    string expected = "6fe28c0ab6f1b372c1a6a246ae63f74f931e8365e15a089c68d6190000000000";
+    if(picosha2::hash256d_hex_string(genesis) != expected) {
+        cout << "❌ sha256d incorrect sur l'en-tête genesis de Bitcoin" << endl;
+        return 1;
+    }
+    cout << "✅ sha256d(genesis Bitcoin) = " << expected << endl;
+
+    mt19937 rng(7);
+    for(size_t size : {32, 80, 256}) {
+        vector<string> messages(2048, string(size, '\0'));
+        for(auto& m : messages) {
+            for(auto& c : m) {
+                c = static_cast<char>(rng());
+            }
+        }
+
+        // Les trois méthodes doivent donner le même digest
+        picosha2::byte_t a[32], b[32], c[32];
+        sha256dViaHex(messages[0], a);
+        sha256dGeneric(messages[0], b);
+        sha256dFused(messages[0], c);
+        if(!equal(a, a + 32, b) || !equal(b, b + 32, c)) {
+            cout << "❌ Résultats divergents pour " << size << " octets" << endl;
+            return 1;
+        }
+
+        double viaHex = benchHashRate(sha256dViaHex, messages, 50);
+        double generic = benchHashRate(sha256dGeneric, messages, 50);
+        double fused = benchHashRate(sha256dFused, messages, 50);
+
+        cout << "\n--- Messages de " << size << " octets ---" << endl;
+        cout << "  " << left << setw(22) << "hex + re-décodage" << right << setw(14) << fixed << setprecision(0) << viaHex << " hash/s" << endl;
+        cout << "  " << left << setw(22) << "2 appels génériques" << right << setw(14) << generic << " hash/s" << endl;
+        cout << "  " << left << setw(22) << "sha256d fusionné" << right << setw(14) << fused << " hash/s"
+             << "  (x" << setprecision(2) << fused / generic << " vs génériques)" << endl;
+    }
+
+    return 0;
+}
+
+/*
+COMPILATION:
+g++ -O2 -o bench_sha256d bench_sha256d.cpp -std=c++11
+
+EXECUTION:
+./bench_sha256d
+*/
@@ -0,0 +1,212 @@
+#ifndef HEX_H
+#define HEX_H
+
+// Encodage / décodage hexadécimal partagé (affichage des hashes,
+// statistiques de bits). Tables de 256 entrées, plus des chemins
+// SSSE3 / AVX2 choisis à l'exécution sur x86.
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define HEX_HAS_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+namespace hex {
+
+// "00" .. "ff" : chaque octet donne ses deux caractères en une lecture
+static const char k_pairs[513] =
+    "000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f"
+    "202122232425262728292a2b2c2d2e2f303132333435363738393a3b3c3d3e3f"
+    "404142434445464748494a4b4c4d4e4f505152535455565758595a5b5c5d5e5f"
+    "606162636465666768696a6b6c6d6e6f707172737475767778797a7b7c7d7e7f"
+    "808182838485868788898a8b8c8d8e8f909192939495969798999a9b9c9d9e9f"
+    "a0a1a2a3a4a5a6a7a8a9aaabacadaeafb0b1b2b3b4b5b6b7b8b9babbbcbdbebf"
+    "c0c1c2c3c4c5c6c7c8c9cacbcccdcecfd0d1d2d3d4d5d6d7d8d9dadbdcdddedf"
+    "e0e1e2e3e4e5e6e7e8e9eaebecedeeeff0f1f2f3f4f5f6f7f8f9fafbfcfdfeff";
+
+static const char k_digits[17] = "0123456789abcdef";
+
+// Valeur d'un caractère hexadécimal (majuscules acceptées), 0xff sinon
+static const uint8_t k_values[256] = {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+};
+
+namespace detail {
+
+inline void encode_scalar(const uint8_t* src, size_t n, char* dst) {
+    for(size_t i = 0; i < n; i++) {
+        std::memcpy(dst + 2 * i, k_pairs + 2 * src[i], 2);
+    }
+}
+
+inline bool decode_scalar(const char* src, size_t n, uint8_t* dst) {
+    uint8_t invalid = 0;
+    for(size_t i = 0; i < n; i++) {
+        uint8_t hi = k_values[static_cast<unsigned char>(src[2 * i])];
+        uint8_t lo = k_values[static_cast<unsigned char>(src[2 * i + 1])];
+        invalid |= hi | lo;
+        dst[i] = static_cast<uint8_t>(hi << 4 | (lo & 0x0f));
+    }
+    return (invalid & 0xf0) == 0;
+}
+
+#ifdef HEX_HAS_X86_SIMD
+// 16 octets -> 32 caractères : pshufb sert de table sur les quartets
+__attribute__((target("ssse3")))
+inline void encode_ssse3(const uint8_t* src, size_t n, char* dst) {
+    const __m128i digits = _mm_loadu_si128(reinterpret_cast<const __m128i*>(k_digits));
+    const __m128i mask = _mm_set1_epi8(0x0f);
+    size_t i = 0;
+    for(; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i hi = _mm_shuffle_epi8(digits, _mm_and_si128(_mm_srli_epi16(v, 4), mask));
+        __m128i lo = _mm_shuffle_epi8(digits, _mm_and_si128(v, mask));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 2 * i), _mm_unpacklo_epi8(hi, lo));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 2 * i + 16), _mm_unpackhi_epi8(hi, lo));
+    }
+    encode_scalar(src + i, n - i, dst + 2 * i);
+}
+
+// 32 octets -> 64 caractères (un digest SHA-256 en une itération)
+__attribute__((target("avx2")))
+inline void encode_avx2(const uint8_t* src, size_t n, char* dst) {
+    const __m256i digits = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(k_digits)));
+    const __m256i mask = _mm256_set1_epi8(0x0f);
+    size_t i = 0;
+    for(; i + 32 <= n; i += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        __m256i hi = _mm256_shuffle_epi8(digits, _mm256_and_si256(_mm256_srli_epi16(v, 4), mask));
+        __m256i lo = _mm256_shuffle_epi8(digits, _mm256_and_si256(v, mask));
+        // unpack travaille par moitié de 128 bits : on remet les moitiés dans l'ordre
+        __m256i a = _mm256_unpacklo_epi8(hi, lo);
+        __m256i b = _mm256_unpackhi_epi8(hi, lo);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + 2 * i), _mm256_permute2x128_si256(a, b, 0x20));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + 2 * i + 32), _mm256_permute2x128_si256(a, b, 0x31));
+    }
+    encode_ssse3(src + i, n - i, dst + 2 * i);
+}
+
+// Valeurs des 16 caractères de `c` ; `ok` garde 0xff pour les caractères valides
+__attribute__((target("ssse3")))
+inline __m128i nibbles_ssse3(__m128i c, __m128i& ok) {
+    __m128i digit = _mm_sub_epi8(c, _mm_set1_epi8('0'));
+    __m128i letter = _mm_sub_epi8(_mm_or_si128(c, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+    __m128i isDigit = _mm_and_si128(_mm_cmpgt_epi8(digit, _mm_set1_epi8(-1)), _mm_cmplt_epi8(digit, _mm_set1_epi8(10)));
+    __m128i isLetter = _mm_and_si128(_mm_cmpgt_epi8(letter, _mm_set1_epi8(-1)), _mm_cmplt_epi8(letter, _mm_set1_epi8(6)));
+    ok = _mm_and_si128(ok, _mm_or_si128(isDigit, isLetter));
+    return _mm_or_si128(_mm_and_si128(isDigit, digit),
+                        _mm_and_si128(isLetter, _mm_add_epi8(letter, _mm_set1_epi8(10))));
+}
+
+// 32 caractères -> 16 octets : maddubs calcule hi * 16 + lo par paire
+__attribute__((target("ssse3")))
+inline bool decode_ssse3(const char* src, size_t n, uint8_t* dst) {
+    const __m128i weights = _mm_set1_epi16(0x0110);
+    __m128i ok = _mm_set1_epi8(-1);
+    size_t i = 0;
+    for(; i + 16 <= n; i += 16) {
+        __m128i a = nibbles_ssse3(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 2 * i)), ok);
+        __m128i b = nibbles_ssse3(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 2 * i + 16)), ok);
+        __m128i bytes = _mm_packus_epi16(_mm_maddubs_epi16(a, weights), _mm_maddubs_epi16(b, weights));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), bytes);
+    }
+    bool valid = _mm_movemask_epi8(ok) == 0xffff;
+    return decode_scalar(src + 2 * i, n - i, dst + i) && valid;
+}
+
+inline bool cpu_has_ssse3() {
+    static const bool supported = __builtin_cpu_supports("ssse3");
+    return supported;
+}
+
+inline bool cpu_has_avx2() {
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+}
+#endif
+
+} // namespace detail
+
+// Écrit les 2n caractères hexadécimaux (minuscules) de src[0, n) dans dst
+inline void encode(const uint8_t* src, size_t n, char* dst) {
+#ifdef HEX_HAS_X86_SIMD
+    if(n >= 32 && detail::cpu_has_avx2()) {
+        detail::encode_avx2(src, n, dst);
+        return;
+    }
+    if(n >= 16 && detail::cpu_has_ssse3()) {
+        detail::encode_ssse3(src, n, dst);
+        return;
+    }
+#endif
+    detail::encode_scalar(src, n, dst);
+}
+
+inline std::string encode(const uint8_t* src, size_t n) {
+    std::string out(2 * n, '\0');
+    if(n > 0) {
+        encode(src, n, &out[0]);
+    }
+    return out;
+}
+
+// Décode 2n caractères en n octets. Retourne false si un caractère
+// n'est pas hexadécimal (dst est alors indéterminé).
+inline bool decode(const char* src, size_t n, uint8_t* dst) {
+#ifdef HEX_HAS_X86_SIMD
+    if(n >= 16 && detail::cpu_has_ssse3()) {
+        return detail::decode_ssse3(src, n, dst);
+    }
+#endif
+    return detail::decode_scalar(src, n, dst);
+}
+
+// Bits d'une chaîne hexadécimale, 4 par caractère, poids fort d'abord.
+// Les caractères non hexadécimaux sont ignorés.
+inline std::vector<bool> to_bits(const std::string& hexString) {
+    std::vector<bool> bits;
+    std::vector<uint8_t> bytes(hexString.size() / 2);
+    if(hexString.size() % 2 == 0 && decode(hexString.data(), bytes.size(), bytes.data())) {
+        bits.resize(8 * bytes.size());
+        for(size_t i = 0; i < bytes.size(); i++) {
+            for(int j = 0; j < 8; j++) {
+                bits[8 * i + j] = (bytes[i] >> (7 - j)) & 1;
+            }
+        }
+        return bits;
+    }
+    bits.reserve(4 * hexString.size());
+    for(char c : hexString) {
+        uint8_t value = k_values[static_cast<unsigned char>(c)];
+        if(value == 0xff) {
+            continue;
+        }
+        for(int j = 3; j >= 0; j--) {
+            bits.push_back((value >> j) & 1);
+        }
+    }
+    return bits;
+}
+
+} // namespace hex
+
+#endif
@@ -0,0 +1,161 @@
+#ifndef MINING_H
+#define MINING_H
+
+// Recherche de nonce parallèle pour la preuve de travail.
+// L'espace des nonces (64 bits) est découpé en tranches contiguës, une par
+// thread du pool. Si toutes les tranches sont épuisées, l'extra-nonce est
+// incrémenté (l'en-tête change) et l'espace est reparcouru. Le premier
+// thread qui trouve lève un drapeau atomique partagé : tous s'arrêtent.
+// Un observateur optionnel reçoit la progression et le bilan final.
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <cstdint>
+#include "parallel.h"
+
+namespace mining {
+
+struct WorkerStats {
+    unsigned long long hashes = 0;
+    double seconds = 0;
+
+    double hashRate() const {
+        return seconds > 0 ? hashes / seconds : 0;
+    }
+};
+
+struct MiningResult {
+    bool found = false;
+    uint64_t nonce = 0;
+    uint64_t extraNonce = 0;
+    unsigned winner = 0;                // thread qui a trouvé
+    double seconds = 0;
+    std::vector<WorkerStats> workers;   // un par thread
+
+    unsigned long long totalHashes() const {
+        unsigned long long total = 0;
+        for(const auto& w : workers) {
+            total += w.hashes;
+        }
+        return total;
+    }
+
+    double hashRate() const {
+        return seconds > 0 ? totalHashes() / seconds : 0;
+    }
+
+    unsigned threads() const {
+        return static_cast<unsigned>(workers.size());
+    }
+};
+
+// Progression d'un thread
+struct MiningProgress {
+    unsigned worker;
+    uint64_t nonce;                 // dernier nonce essayé
+    uint64_t extraNonce;
+    unsigned long long hashes;      // essais de ce thread depuis le début
+    double seconds;
+
+    double hashRate() const {
+        return seconds > 0 ? hashes / seconds : 0;
+    }
+};
+
+// Observateur de minage. onProgress est appelé tous les progressInterval
+// essais de chaque thread (0 : jamais), depuis les threads du pool mais
+// jamais deux à la fois ; onFinish une fois, par l'appelant, avec le bilan.
+class MiningObserver {
+public:
+    unsigned long long progressInterval;
+
+    explicit MiningObserver(unsigned long long interval = 0) : progressInterval(interval) {}
+    virtual ~MiningObserver() {}
+
+    virtual void onProgress(const MiningProgress& progress) { (void)progress; }
+    virtual void onFinish(const MiningResult& result) { (void)result; }
+};
+
+struct MiningLimits {
+    uint64_t nonceSpace = UINT64_MAX;   // nonces [0, nonceSpace) par extra-nonce
+    uint64_t extraNonces = UINT64_MAX;  // extra-nonces essayés avant abandon
+};
+
+// makeJob(worker, extraNonce) est appelé par chaque thread au début de
+// chaque extra-nonce (c'est là que se prépare le midstate) et renvoie un
+// appelable bool(uint64_t nonce), vrai si le nonce satisfait la cible.
+// Le travail doit être réentrant : un objet par thread, rien de partagé.
+// Chaque tranche est parcourue par tronçons qui s'arrêtent au prochain
+// rapport de progression : sans observateur, un seul tronçon, et la boucle
+// interne ne fait aucun test de plus.
+template<typename MakeJob>
+MiningResult mine(MakeJob makeJob, MiningLimits limits = MiningLimits(),
+                  parallel::ThreadPool& pool = parallel::defaultPool(),
+                  MiningObserver* observer = nullptr) {
+    typedef std::chrono::steady_clock Clock;
+    unsigned threads = pool.size();
+    MiningResult result;
+    result.workers.resize(threads);
+    std::atomic<bool> stop(false);
+    std::mutex resultMutex;
+    std::mutex observerMutex;
+    unsigned long long interval = observer ? observer->progressInterval : 0;
+
+    Clock::time_point start = Clock::now();
+    pool.run(threads, [&](size_t worker) {
+        Clock::time_point workerStart = Clock::now();
+        unsigned long long hashes = 0;
+        // Tranche [first, last) de ce thread dans l'espace des nonces
+        uint64_t share = limits.nonceSpace / threads;
+        uint64_t first = share * worker;
+        uint64_t last = (worker + 1 == threads) ? limits.nonceSpace : first + share;
+        unsigned long long nextReport = interval ? interval : ~0ULL;
+
+        for(uint64_t extra = 0; extra < limits.extraNonces && !stop.load(std::memory_order_relaxed); extra++) {
+            auto job = makeJob(static_cast<unsigned>(worker), extra);
+            uint64_t nonce = first;
+            while(nonce < last && !stop.load(std::memory_order_relaxed)) {
+                uint64_t chunkEnd = (nextReport - hashes < last - nonce) ? nonce + (nextReport - hashes) : last;
+                for(; nonce < chunkEnd; nonce++) {
+                    if(stop.load(std::memory_order_relaxed)) {
+                        break;
+                    }
+                    hashes++;
+                    if(job(nonce)) {
+                        std::lock_guard<std::mutex> lock(resultMutex);
+                        if(!result.found) {
+                            result.found = true;
+                            result.nonce = nonce;
+                            result.extraNonce = extra;
+                            result.winner = static_cast<unsigned>(worker);
+                            stop.store(true, std::memory_order_relaxed);
+                        }
+                        break;
+                    }
+                }
+                if(hashes == nextReport && !stop.load(std::memory_order_relaxed)) {
+                    std::chrono::duration<double> sofar = Clock::now() - workerStart;
+                    MiningProgress progress = {static_cast<unsigned>(worker), nonce - 1, extra, hashes, sofar.count()};
+                    std::lock_guard<std::mutex> lock(observerMutex);
+                    observer->onProgress(progress);
+                    nextReport += interval;
+                }
+            }
+        }
+
+        std::chrono::duration<double> elapsed = Clock::now() - workerStart;
+        result.workers[worker].hashes = hashes;
+        result.workers[worker].seconds = elapsed.count();
+    });
+    std::chrono::duration<double> elapsed = Clock::now() - start;
+    result.seconds = elapsed.count();
+    if(observer) {
+        observer->onFinish(result);
+    }
+    return result;
+}
+
+} // namespace mining
+
+#endif
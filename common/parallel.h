@@ -0,0 +1,158 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+// Petit pool de threads partagé et boucle parallèle par tranches.
+// Le thread appelant participe au travail ; sous le seuil donné,
+// tout reste sur le thread appelant (pas de synchronisation).
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <algorithm>
+#include <cstddef>
+
+namespace parallel {
+
+class ThreadPool {
+public:
+    // `threads` compte le thread appelant : ThreadPool(1) n'en crée aucun
+    explicit ThreadPool(unsigned threads = std::thread::hardware_concurrency()) {
+        for(unsigned i = 1; i < std::max(1u, threads); i++) {
+            workers.emplace_back([this]() { workerLoop(); });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for(auto& w : workers) {
+            w.join();
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    unsigned size() const {
+        return static_cast<unsigned>(workers.size()) + 1;
+    }
+
+    // Exécute task(i) pour i dans [0, tasks) et attend la fin.
+    // Appelé depuis une tâche du pool, qu'elle tourne sur un worker ou sur
+    // le thread appelant, s'exécute en série (pas d'interblocage).
+    void run(size_t tasks, const std::function<void(size_t)>& task) {
+        if(workers.empty() || tasks <= 1 || insideWorker()) {
+            for(size_t i = 0; i < tasks; i++) {
+                task(i);
+            }
+            return;
+        }
+
+        std::lock_guard<std::mutex> runLock(runMutex);   // un travail à la fois
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            job = &task;
+            jobTasks = tasks;
+            next = 0;
+            activeWorkers = workers.size();
+            generation++;
+        }
+        wake.notify_all();
+
+        // Le thread appelant exécute aussi des tâches : un run() imbriqué
+        // depuis l'une d'elles ne doit pas reprendre runMutex
+        insideWorker() = true;
+        work(task, tasks);
+        insideWorker() = false;
+
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [this]() { return activeWorkers == 0; });
+        job = nullptr;
+    }
+
+private:
+    std::vector<std::thread> workers;
+    std::mutex runMutex;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    const std::function<void(size_t)>* job = nullptr;
+    size_t jobTasks = 0;
+    std::atomic<size_t> next{0};
+    size_t activeWorkers = 0;
+    unsigned long long generation = 0;
+    bool stopping = false;
+
+    static bool& insideWorker() {
+        static thread_local bool inside = false;
+        return inside;
+    }
+
+    void work(const std::function<void(size_t)>& task, size_t tasks) {
+        size_t i;
+        while((i = next++) < tasks) {
+            task(i);
+        }
+    }
+
+    void workerLoop() {
+        insideWorker() = true;
+        unsigned long long seen = 0;
+        while(true) {
+            const std::function<void(size_t)>* task;
+            size_t tasks;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&]() { return stopping || generation != seen; });
+                if(stopping) {
+                    return;
+                }
+                seen = generation;
+                task = job;
+                tasks = jobTasks;
+            }
+            work(*task, tasks);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if(--activeWorkers == 0) {
+                    done.notify_one();
+                }
+            }
+        }
+    }
+};
+
+// Pool global, créé au premier usage avec un thread par coeur
+inline ThreadPool& defaultPool() {
+    static ThreadPool pool;
+    return pool;
+}
+
+// Appelle body(begin, end) sur des tranches contiguës couvrant [0, n).
+// Sous `threshold` éléments, un seul appel body(0, n) sur le thread courant.
+template<typename Body>
+void parallelFor(size_t n, size_t threshold, Body body, ThreadPool& pool = defaultPool()) {
+    if(n < threshold || pool.size() == 1) {
+        if(n > 0) {
+            body(size_t(0), n);
+        }
+        return;
+    }
+    // Quelques tranches par thread pour lisser les écarts de charge
+    size_t chunks = std::min<size_t>(4 * pool.size(), n);
+    size_t chunkSize = (n + chunks - 1) / chunks;
+    chunks = (n + chunkSize - 1) / chunkSize;
+    pool.run(chunks, [&](size_t c) {
+        size_t begin = c * chunkSize;
+        body(begin, std::min(n, begin + chunkSize));
+    });
+}
+
+} // namespace parallel
+
+#endif
@@ -0,0 +1,35 @@
+#include <iostream>
+#include <string>
+#include "../Atelier1/merkle.h"
+
+using namespace std;
+
+// Affiche la racine de Merkle de chaque fichier (une transaction par
+// ligne). Le fichier est lu en flux : la mémoire reste bornée quel que
+// soit le nombre de transactions.
+int main(int argc, char* argv[]) {
+    if(argc < 2) {
+        cerr << "Usage: " << argv[0] << " fichier..." << endl;
+        return 1;
+    }
+
+    int status = 0;
+    for(int i = 1; i < argc; i++) {
+        Hash256 root;
+        if(!streamingMerkleRootFromFile(argv[i], root)) {
+            cerr << "Erreur: impossible de lire " << argv[i] << endl;
+            status = 1;
+            continue;
+        }
+        cout << root.toHex() << "  " << argv[i] << "\n";
+    }
+    return status;
+}
+
+/*
+COMPILATION:
+g++ -O2 -o merkle_root merkle_root.cpp -std=c++14 -pthread
+
+EXECUTION:
+./merkle_root transactions_bloc_42.txt
+*/
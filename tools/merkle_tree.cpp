@@ -0,0 +1,71 @@
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include "../Atelier1/merkle_file.h"
+
+using namespace std;
+
+// Arbre de Merkle sur disque pour les audits de très gros volumes :
+// construit une fois à partir d'un fichier de transactions (une par
+// ligne), puis rouvert pour afficher la racine ou produire des preuves
+// sans reconstruire l'arbre.
+void usage(const char* program) {
+    cerr << "Usage: " << program << " build transactions.txt arbre.mrk\n"
+         << "       " << program << " root arbre.mrk\n"
+         << "       " << program << " proof arbre.mrk index" << endl;
+}
+
+int main(int argc, char* argv[]) {
+    if(argc < 3) {
+        usage(argv[0]);
+        return 1;
+    }
+    string command = argv[1];
+
+    if(command == "build" && argc == 4) {
+        if(!FileMerkleTree::buildFromFile(argv[2], argv[3])) {
+            cerr << "Erreur: impossible de construire " << argv[3] << endl;
+            return 1;
+        }
+    } else if((command != "root" || argc != 3) && (command != "proof" || argc != 4)) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    FileMerkleTree tree;
+    const char* treePath = (command == "build") ? argv[3] : argv[2];
+    if(!tree.open(treePath)) {
+        cerr << "Erreur: " << treePath << " n'est pas un arbre valide" << endl;
+        return 1;
+    }
+
+    if(command != "proof") {
+        cout << tree.getRoot().toHex() << "  " << tree.getLeafCount() << " transactions" << endl;
+        return 0;
+    }
+
+    size_t index = static_cast<size_t>(strtoull(argv[3], nullptr, 10));
+    if(index >= tree.getLeafCount()) {
+        cerr << "Erreur: index hors de l'arbre (" << tree.getLeafCount() << " transactions)" << endl;
+        return 1;
+    }
+    MerkleProof proof = tree.generateProof(index);
+    cout << "feuille " << index << ": " << tree.getLeaf(index).toHex() << "\n";
+    for(size_t level = 0; level < proof.siblings.size(); level++) {
+        cout << "  niveau " << level << (proof.siblingOnLeft(level) ? " G " : " D ")
+             << proof.siblings[level].toHex() << "\n";
+    }
+    cout << "racine: " << tree.getRoot().toHex() << " ("
+         << (verifyMerkleProof(tree.getLeaf(index), proof, tree.getRoot()) ? "preuve valide" : "preuve INVALIDE")
+         << ")" << endl;
+    return 0;
+}
+
+/*
+COMPILATION:
+g++ -O2 -o merkle_tree merkle_tree.cpp -std=c++14 -pthread
+
+EXECUTION:
+./merkle_tree build transactions_audit.txt audit.mrk
+./merkle_tree proof audit.mrk 123456
+*/
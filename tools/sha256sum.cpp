@@ -0,0 +1,66 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <cstdlib>
+#include "../Atelier1/picosha2_file.h"
+
+using namespace std;
+
+// Affiche le SHA-256 de chaque fichier (format de sha256sum).
+// Les fichiers sont répartis entre plusieurs threads ; l'ordre de sortie
+// reste celui des arguments.
+int main(int argc, char* argv[]) {
+    unsigned int threads = max(1u, thread::hardware_concurrency());
+    vector<string> paths;
+
+    for(int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if(arg == "-j" && i + 1 < argc) {
+            threads = max(1, atoi(argv[++i]));
+        } else {
+            paths.push_back(arg);
+        }
+    }
+
+    if(paths.empty()) {
+        cerr << "Usage: " << argv[0] << " [-j threads] fichier..." << endl;
+        return 1;
+    }
+
+    vector<string> digests(paths.size());
+    atomic<size_t> next(0);
+    vector<thread> workers;
+    for(unsigned int t = 0; t < min<size_t>(threads, paths.size()); t++) {
+        workers.emplace_back([&]() {
+            size_t i;
+            while((i = next++) < paths.size()) {
+                digests[i] = picosha2::hash_file_hex_string(paths[i]);
+            }
+        });
+    }
+    for(auto& w : workers) {
+        w.join();
+    }
+
+    int status = 0;
+    for(size_t i = 0; i < paths.size(); i++) {
+        if(digests[i].empty()) {
+            cerr << "Erreur: impossible de lire " << paths[i] << endl;
+            status = 1;
+        } else {
+            cout << digests[i] << "  " << paths[i] << "\n";
+        }
+    }
+    return status;
+}
+
+/*
+COMPILATION:
+g++ -O2 -o sha256sum sha256sum.cpp -std=c++11 -pthread
+
+EXECUTION:
+./sha256sum -j 8 chain_export_*.bin
+*/